@@ -0,0 +1,111 @@
+#include "arena.h"
+#include <stdarg.h> // va_list
+#include <stdint.h> // uintptr_t
+#include <stdio.h>  // vsnprintf
+#include <stdlib.h> // malloc / free
+#include <string.h> // memcpy
+#include <new>      // std::bad_alloc
+
+const size_t Arena::MAX_RETAIN;
+
+Arena::Arena(size_t blockSize)
+    : head_(nullptr), ptr_(nullptr), end_(nullptr), blockSize_(blockSize), used_(0), capacity_(0) {}
+
+Arena::~Arena() {
+    FreeBlocks_();
+}
+
+void Arena::FreeBlocks_() {
+    while (head_) {
+        Block* prev = head_->prev;
+        free(head_);
+        head_ = prev;
+    }
+    ptr_ = end_ = nullptr;
+    capacity_ = 0;
+}
+
+// 新块至少能放下 minSize 字节；之前的块留在链表中，Reset 时再处理
+void Arena::NewBlock_(size_t minSize) {
+    size_t size = minSize > blockSize_ ? minSize : blockSize_;
+    Block* block = static_cast<Block*>(malloc(sizeof(Block) + size));
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    block->prev = head_;
+    block->size = size;
+    head_ = block;
+    ptr_ = reinterpret_cast<char*>(block + 1);
+    end_ = ptr_ + size;
+    capacity_ += size;
+}
+
+void* Arena::Alloc(size_t size, size_t align) {
+    uintptr_t p = (reinterpret_cast<uintptr_t>(ptr_) + align - 1) & ~(align - 1);
+    if (!head_ || p + size > reinterpret_cast<uintptr_t>(end_)) {
+        NewBlock_(size + align);
+        p = (reinterpret_cast<uintptr_t>(ptr_) + align - 1) & ~(align - 1);
+    }
+    ptr_ = reinterpret_cast<char*>(p + size);
+    used_ += size;
+    return reinterpret_cast<void*>(p);
+}
+
+char* Arena::Copy(const char* s, size_t len) {
+    char* str = static_cast<char*>(Alloc(len + 1, 1));
+    memcpy(str, s, len);
+    str[len] = '\0';
+    return str;
+}
+
+char* Arena::Concat(const char* a, size_t alen, const char* b, size_t blen) {
+    char* str = static_cast<char*>(Alloc(alen + blen + 1, 1));
+    memcpy(str, a, alen);
+    memcpy(str + alen, b, blen);
+    str[alen + blen] = '\0';
+    return str;
+}
+
+// 先直接格式化到当前块的剩余空间，放不下时按实际长度分配后再格式化一次
+char* Arena::Format(size_t* len, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    size_t room = head_ ? end_ - ptr_ : 0;
+    va_list copy;
+    va_copy(copy, ap);
+    int n = vsnprintf(ptr_, room, fmt, copy);
+    va_end(copy);
+    if (n < 0) {
+        va_end(ap);
+        return nullptr;
+    }
+    char* str;
+    if (static_cast<size_t>(n) < room) {
+        str = static_cast<char*>(Alloc(n + 1, 1)); // 就是刚才写入的位置
+    } else {
+        str = static_cast<char*>(Alloc(n + 1, 1));
+        vsnprintf(str, n + 1, fmt, ap);
+    }
+    va_end(ap);
+    if (len) {
+        *len = n;
+    }
+    return str;
+}
+
+void Arena::Reset() {
+    used_ = 0;
+    if (!head_) {
+        return;
+    }
+    if (head_->prev || capacity_ > MAX_RETAIN) {
+        // 用到了多块：下一块按这次的总量申请，下个同样大小的请求一块就够；超过 MAX_RETAIN 的偶发大请求不计入
+        size_t total = capacity_;
+        FreeBlocks_();
+        if (total <= MAX_RETAIN) {
+            blockSize_ = total;
+        }
+        return;
+    }
+    ptr_ = reinterpret_cast<char*>(head_ + 1);
+}
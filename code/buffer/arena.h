@@ -0,0 +1,58 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h> // size_t / max_align_t
+
+// 按块申请、线性分配（bump pointer）的内存池：Alloc 只移动指针，不单独释放，Reset 一次性回收。
+// 用于一个请求/响应期间的临时数据（拼接的文件路径、错误页面、解码后的表单字段等）：
+//   - 第一块在第一次分配时申请，Reset 后保留，下一个请求直接复用；
+//   - 一个请求用超了就追加新块，Reset 时把各块合并成一块，之后同样大小的请求不再调用 malloc；
+//     总容量超过 MAX_RETAIN 时（偶发的大请求）Reset 把内存全部归还，不按它扩大；
+//   - 分配出的内存在下一次 Reset 之前有效；不是线程安全的，同一时间只能有一个线程使用
+class Arena {
+public:
+    static const size_t MAX_RETAIN = 64 * 1024; // Reset 后最多保留的容量
+
+    explicit Arena(size_t blockSize = 1024);
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // 分配 size 字节（按 align 对齐，align 须为 2 的幂）
+    void* Alloc(size_t size, size_t align = alignof(max_align_t));
+
+    // 拷贝 [s, s + len) 为以 '\0' 结尾的字符串
+    char* Copy(const char* s, size_t len);
+    // 拼接两段为以 '\0' 结尾的字符串（如 根目录 + 请求路径）
+    char* Concat(const char* a, size_t alen, const char* b, size_t blen);
+    // 按 printf 格式生成以 '\0' 结尾的字符串，len 非空时写入长度
+    char* Format(size_t* len, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+
+    // 回收本轮分配的全部内存（见类注释）
+    void Reset();
+
+    size_t Used() const { // 本轮已分配的字节数
+        return used_;
+    }
+    size_t Capacity() const { // 各块容量之和
+        return capacity_;
+    }
+
+private:
+    struct Block {
+        Block* prev; // 之前申请的块
+        size_t size; // 数据区大小（紧跟在 Block 之后）
+    };
+
+    void NewBlock_(size_t minSize);
+    void FreeBlocks_();
+
+    Block* head_;      // 当前（最新）的块
+    char* ptr_;        // 当前块中下一个可分配的位置
+    char* end_;        // 当前块的末尾
+    size_t blockSize_; // 新块的默认大小
+    size_t used_;
+    size_t capacity_;
+};
+
+#endif // ARENA_H
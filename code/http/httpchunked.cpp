@@ -0,0 +1,187 @@
+#include "httpchunked.h"
+#include <stdio.h> // snprintf
+
+const int ChunkedDecoder::MAX_SIZE_DIGITS;
+const size_t ChunkedDecoder::MAX_LINE;
+
+void ChunkedDecoder::Reset() {
+    state_ = S_SIZE;
+    error_ = ERR_NONE;
+    left_ = 0;
+    digits_ = 0;
+    lineLen_ = 0;
+}
+
+size_t ChunkedDecoder::Fail_(ERROR_CODE code, size_t used) {
+    state_ = S_ERROR;
+    error_ = code;
+    return used;
+}
+
+static int HexValue(char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+// chunk-ext 和 trailer 中允许 HTAB 和可见字符（含 obs-text），不允许其他控制字符
+static bool IsLineChar(char c) {
+    unsigned char u = static_cast<unsigned char>(c);
+    return u == '\t' || (u >= 0x20 && u != 0x7F);
+}
+
+size_t ChunkedDecoder::Decode(const char* data, size_t len, const char** out, size_t* outLen) {
+    *out = nullptr;
+    *outLen = 0;
+    size_t i = 0;
+    while (i < len) {
+        char c = data[i];
+        switch (state_) {
+            case S_SIZE: {
+                int v = HexValue(c);
+                if (v >= 0) {
+                    if (++digits_ > MAX_SIZE_DIGITS) {
+                        return Fail_(ERR_SIZE, i);
+                    }
+                    left_ = left_ * 16 + v;
+                } else if (digits_ == 0) {
+                    return Fail_(ERR_SIZE, i);
+                } else if (c == ';' || c == ' ' || c == '\t') {
+                    state_ = S_EXT;
+                    lineLen_ = 1;
+                } else if (c == '\r') {
+                    state_ = S_SIZE_LF;
+                } else if (c == '\n') {
+                    state_ = left_ > 0 ? S_DATA : S_TRAILER_START;
+                } else {
+                    return Fail_(ERR_SIZE, i);
+                }
+                i++;
+                break;
+            }
+            case S_EXT:
+                if (c == '\r') {
+                    state_ = S_SIZE_LF;
+                } else if (c == '\n') {
+                    state_ = left_ > 0 ? S_DATA : S_TRAILER_START;
+                } else if (!IsLineChar(c) || ++lineLen_ > MAX_LINE) {
+                    return Fail_(ERR_EXT, i);
+                }
+                i++;
+                break;
+            case S_SIZE_LF:
+                if (c != '\n') {
+                    return Fail_(ERR_LINE_END, i);
+                }
+                state_ = left_ > 0 ? S_DATA : S_TRAILER_START;
+                i++;
+                break;
+            case S_DATA: {
+                // 整段交出：已到达的部分和这个 chunk 剩余长度取小
+                size_t n = len - i < left_ ? len - i : left_;
+                *out = data + i;
+                *outLen = n;
+                left_ -= n;
+                if (left_ == 0) {
+                    state_ = S_DATA_END;
+                }
+                return i + n;
+            }
+            case S_DATA_END:
+                if (c == '\r') {
+                    state_ = S_DATA_LF;
+                } else if (c == '\n') {
+                    state_ = S_SIZE;
+                    digits_ = 0;
+                } else {
+                    return Fail_(ERR_LINE_END, i);
+                }
+                i++;
+                break;
+            case S_DATA_LF:
+                if (c != '\n') {
+                    return Fail_(ERR_LINE_END, i);
+                }
+                state_ = S_SIZE;
+                digits_ = 0;
+                i++;
+                break;
+            case S_TRAILER_START:
+                if (c == '\r') {
+                    state_ = S_END_LF;
+                } else if (c == '\n') {
+                    state_ = S_DONE;
+                    return i + 1;
+                } else if (!IsLineChar(c) || ++lineLen_ > MAX_LINE) {
+                    return Fail_(ERR_TRAILER, i);
+                } else {
+                    state_ = S_TRAILER;
+                }
+                i++;
+                break;
+            case S_TRAILER:
+                if (c == '\r') {
+                    state_ = S_TRAILER_LF;
+                } else if (c == '\n') {
+                    state_ = S_TRAILER_START;
+                } else if (!IsLineChar(c) || ++lineLen_ > MAX_LINE) {
+                    return Fail_(ERR_TRAILER, i);
+                }
+                i++;
+                break;
+            case S_TRAILER_LF:
+                if (c != '\n') {
+                    return Fail_(ERR_LINE_END, i);
+                }
+                state_ = S_TRAILER_START;
+                i++;
+                break;
+            case S_END_LF:
+                if (c != '\n') {
+                    return Fail_(ERR_LINE_END, i);
+                }
+                state_ = S_DONE;
+                return i + 1;
+            case S_DONE:
+            case S_ERROR: return i;
+        }
+    }
+    return i;
+}
+
+const char* ChunkedDecoder::ErrorStr(ERROR_CODE code) {
+    switch (code) {
+        case ERR_NONE: return "none";
+        case ERR_SIZE: return "invalid chunk size";
+        case ERR_EXT: return "invalid chunk extension";
+        case ERR_LINE_END: return "invalid chunk line end";
+        case ERR_TRAILER: return "invalid trailer";
+    }
+    return "unknown";
+}
+
+void ChunkedWriter::Write(const char* data, size_t len) {
+    if (len == 0) {
+        return;
+    }
+    if (framed_) {
+        char size[24];
+        int n = snprintf(size, sizeof(size), "%zx\r\n", len);
+        buff_.Append(size, n);
+    }
+    buff_.Append(data, len);
+    if (framed_) {
+        buff_.Append("\r\n", 2);
+    }
+    written_ += len;
+}
+
+void ChunkedWriter::End() {
+    if (framed_) {
+        buff_.Append("0\r\n\r\n", 5);
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef HTTP_CHUNKED_H
+#define HTTP_CHUNKED_H
+
+#include <stddef.h> // size_t
+#include <string>   // ChunkedWriter::Write(std::string)
+
+#include "../buffer/buffer.h"
+
+// Transfer-Encoding: chunked 的增量解码器（RFC 9112 7.1）：
+//   chunk = chunk-size [ chunk-ext ] CRLF chunk-data CRLF，以大小为 0 的 last-chunk、可选的 trailer 和空行结束。
+//   - 可以分多次喂数据，状态（包括一个 chunk 还剩多少字节）跨调用保存，每个字节只看一次；
+//   - 不拷贝数据：每次遇到 chunk-data 就停下，把它在输入中的位置交给调用方，由调用方决定放进内存还是转存；
+//   - chunk-ext 和 trailer 字段只检查行结构后丢弃（各自有长度上限）；行尾与 HttpParser 一致，接受 CRLF 或单独的 LF。
+class ChunkedDecoder {
+public:
+    enum ERROR_CODE {
+        ERR_NONE = 0,
+        ERR_SIZE,      // chunk-size 为空、含非十六进制字符或超过 MAX_SIZE_DIGITS 位
+        ERR_EXT,       // chunk-ext 含控制字符或超过 MAX_LINE
+        ERR_LINE_END,  // CR 后面不是 LF，或 chunk-data 后面不是行尾
+        ERR_TRAILER,   // trailer 字段含控制字符或总长度超过 MAX_LINE
+    };
+
+    static const int MAX_SIZE_DIGITS = 15;  // chunk-size 最多 15 位十六进制（60 位，不会溢出）
+    static const size_t MAX_LINE = 4096;    // chunk-ext / trailer 的最大总字节数
+
+    ChunkedDecoder() {
+        Reset();
+    }
+
+    void Reset(); // 开始解码新的请求体
+
+    // 从 data 开始解码，至多消费 len 字节：遇到 chunk-data 时停下，*out / *outLen 指向其中已到达的部分
+    // （在 [data, data + len) 内，不超过这个 chunk 剩余的长度），否则 *outLen 为 0。
+    // 返回消费的字节数（含交出的数据）；消费完、解码结束（Done）或出错（Failed）时返回
+    size_t Decode(const char* data, size_t len, const char** out, size_t* outLen);
+
+    bool Done() const {
+        return state_ == S_DONE;
+    }
+    bool Failed() const {
+        return state_ == S_ERROR;
+    }
+    ERROR_CODE Error() const {
+        return error_;
+    }
+    static const char* ErrorStr(ERROR_CODE code);
+
+private:
+    enum STATE {
+        S_SIZE,          // chunk-size（至少一位十六进制）
+        S_EXT,           // chunk-ext，跳过直到行尾
+        S_SIZE_LF,       // chunk-size 行的 CR 之后
+        S_DATA,          // chunk-data，还剩 left_ 字节
+        S_DATA_END,      // chunk-data 之后的行尾
+        S_DATA_LF,       // chunk-data 之后 CR 之后
+        S_TRAILER_START, // last-chunk 之后：空行结束，否则是 trailer 字段
+        S_TRAILER,       // trailer 字段，跳过直到行尾
+        S_TRAILER_LF,    // trailer 字段 CR 之后
+        S_END_LF,        // 结尾空行 CR 之后
+        S_DONE,
+        S_ERROR,
+    };
+
+    size_t Fail_(ERROR_CODE code, size_t used);
+
+    STATE state_;
+    ERROR_CODE error_;
+    size_t left_;    // 当前 chunk 剩余字节（S_SIZE 中为正在累加的大小）
+    int digits_;     // chunk-size 已读的位数
+    size_t lineLen_; // chunk-ext / trailer 已读的字节数
+};
+
+// 分块响应的写出器：把生成的内容按 chunk 格式追加到 Buffer。每次 Write 生成一个 chunk，End 追加 last-chunk 和结尾空行。
+// 对方是 HTTP/1.0 时（不认识 chunked）以 framed = false 构造，内容原样追加，响应以关闭连接结束
+class ChunkedWriter {
+public:
+    explicit ChunkedWriter(Buffer& buff, bool framed = true) : buff_(buff), framed_(framed), written_(0) {}
+
+    void Write(const char* data, size_t len); // len 为 0 时什么也不做（空 chunk 会被当成结束）
+    void Write(const std::string& str) {
+        Write(str.data(), str.size());
+    }
+    void End();
+
+    // 这个写出器已追加的内容字节数（不含 chunk 格式）
+    size_t Written() const {
+        return written_;
+    }
+
+private:
+    Buffer& buff_;
+    bool framed_;
+    size_t written_;
+};
+
+#endif // HTTP_CHUNKED_H
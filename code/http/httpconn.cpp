@@ -4,34 +4,97 @@
 const char* HttpConn::srcDir;         // 网站资源根目录，例如 ./resources
 std::atomic<int> HttpConn::userCount; // 当前连接数（多线程环境下必须 atomic）
 bool HttpConn::isET;                  // 是否使用 Epoll ET（边缘触发）模式
+int HttpConn::pipelineDepth = HttpConn::MAX_PIPELINE;
+size_t HttpConn::readHighWater = HttpRequest::bodyMemLimit + HttpParser::MAX_HEAD_SIZE;
+HttpRouter HttpConn::router;
+HttpConn::Handler HttpConn::requestHandler;
+
+// 返回 srcDir 下的 file
+static bool ServeFile(const HttpRequest& req, HttpResponse& resp, const std::string& file) {
+    resp.Init(HttpConn::srcDir, file, req.IsKeepAlive(), 200);
+    return true;
+}
+
+void HttpConn::AddSiteRoutes(HttpRouter& router) {
+    router.Any("/", [](const HttpRequest& req, const HttpRouter::Params&, HttpResponse& resp) {
+        return ServeFile(req, resp, "/index.html"); // 首页
+    });
+    for (const char* page : {"/index", "/register", "/login", "/welcome", "/video", "/picture"}) {
+        std::string file = std::string(page) + ".html";
+        router.Any(page, [file](const HttpRequest& req, const HttpRouter::Params&, HttpResponse& resp) {
+            return ServeFile(req, resp, file); // 自动加 .html 后缀
+        });
+    }
+    // 表单提交到页面本身（带不带 .html 都可以）；不是表单的 POST 照常返回页面
+    for (const char* page : {"/login", "/register"}) {
+        std::string file = std::string(page) + ".html";
+        bool isLogin = file == "/login.html";
+        HttpRouter::Handler verify = [file, isLogin](const HttpRequest& req, const HttpRouter::Params&,
+                                                     HttpResponse& resp) {
+            if (!req.GetHeader(HttpNames::H_CONTENT_TYPE).IEquals("application/x-www-form-urlencoded")) {
+                return ServeFile(req, resp, file);
+            }
+            bool ok = HttpRequest::UserVerify(req.GetPost("username"), req.GetPost("password"), isLogin);
+            return ServeFile(req, resp, ok ? "/welcome.html" : "/error.html"); // 验证成功/失败跳转
+        };
+        router.Post(page, verify);
+        router.Post(file, verify);
+    }
+}
 
 HttpConn::HttpConn() {
     fd_ = -1;        // 默认无文件描述符
-    addr_ = {0};     // 初始化 IP 地址结构体
+    addr_ = {};      // 初始化地址结构体
+    ip_[0] = '\0';
     isClose_ = true; // 默认连接关闭状态
+    iovCnt_ = iovIdx_ = 0;
+    toWrite_ = 0;
+    keepAlive_ = false;
+    generating_ = false;
+    respCnt_ = 0;
+    request_.SetArena(&arena_);
+    for (int i = 0; i < MAX_PIPELINE; i++) {
+        responses_[i].SetArena(&arena_);
+    }
 }
 
 HttpConn::~HttpConn() {
     Close(); // 析构时关闭连接（防止资源泄露）
 }
 
-void HttpConn::init(int fd, const sockaddr_in& addr) {
+void HttpConn::init(int fd, const sockaddr_storage& addr) {
     assert(fd > 0);           // 断言 fd 合法
     userCount++;              // 连接数 +1（atomic，线程安全）
     addr_ = addr;             // 保存客户端地址信息
+    if (addr_.ss_family == AF_INET) {
+        inet_ntop(AF_INET, &reinterpret_cast<const sockaddr_in&>(addr_).sin_addr, ip_, sizeof(ip_));
+    } else if (addr_.ss_family == AF_INET6) {
+        inet_ntop(AF_INET6, &reinterpret_cast<const sockaddr_in6&>(addr_).sin6_addr, ip_, sizeof(ip_));
+    } else {
+        strcpy(ip_, "unix"); // Unix 域的对端通常是未绑定路径的匿名 socket
+    }
     fd_ = fd;                 // 保存客户端连接fd
     writeBuff_.RetrieveAll(); // 清空发送缓冲区
     readBuff_.RetrieveAll();  // 清空接收缓冲区
+    request_.Init();          // 丢弃上一个连接未完成的解析进度
+    iovCnt_ = iovIdx_ = 0;    // 没有待写的响应
+    toWrite_ = 0;
+    respCnt_ = 0;
+    generating_ = false;
     isClose_ = false;         // 标记连接处于开启状态
     LOG_INFO("Client[%d](%s:%d) in, userCount:%d", fd_, GetIP(), GetPort(), (int)userCount);
 }
 
-void HttpConn::Close() {
-    response_.UnmapFile();   // 解绑文件映射（mmap）
+void HttpConn::Close(bool closeFd) {
+    for (int i = 0; i < respCnt_; i++) {
+        responses_[i].UnmapFile(); // 解绑文件映射（mmap）
+    }
     if (isClose_ == false) { // 若当前连接仍然开启
         isClose_ = true;
         userCount--; // 连接数 -1
-        close(fd_);  // 关闭 socket fd
+        if (closeFd) {
+            close(fd_); // 关闭 socket fd
+        }
         LOG_INFO("Client[%d](%s:%d) quit, UserCount:%d", fd_, GetIP(), GetPort(), (int)userCount);
     }
 }
@@ -40,16 +103,22 @@ int HttpConn::GetFd() const {
     return fd_; // 返回 socket fd
 }
 
-struct sockaddr_in HttpConn::GetAddr() const {
-    return addr_; // 返回连接客户端 IP 信息
+const sockaddr_storage& HttpConn::GetAddr() const {
+    return addr_; // 返回连接客户端地址信息
 }
 
 const char* HttpConn::GetIP() const {
-    return inet_ntoa(addr_.sin_addr); // 返回客户端 IP 字符串
+    return ip_; // 返回客户端地址字符串
 }
 
 int HttpConn::GetPort() const {
-    return addr_.sin_port; // 端口号（注意是网络字节序）
+    if (addr_.ss_family == AF_INET) {
+        return ntohs(reinterpret_cast<const sockaddr_in&>(addr_).sin_port);
+    }
+    if (addr_.ss_family == AF_INET6) {
+        return ntohs(reinterpret_cast<const sockaddr_in6&>(addr_).sin6_port);
+    }
+    return 0;
 }
 
 ssize_t HttpConn::read(int* saveErrno) {
@@ -60,78 +129,155 @@ ssize_t HttpConn::read(int* saveErrno) {
         if (len <= 0) {
             break; // 读取失败或结束
         }
-    } while (isET); // 如果是 ET 模式，需要循环读取直到无数据
+    } while (isET && readBuff_.ReadableBytes() < readHighWater); // ET 模式循环读取直到无数据或缓冲区达到上限
     return len;
 }
 
 ssize_t HttpConn::write(int* saveErrno) {
     ssize_t len = -1;
     do {
-        // writev 一次发送多个缓冲区（响应头 + 文件内容）
-        len = writev(fd_, iov_, iovCnt_);
+        // writev 一次发送多个缓冲区（这一批的所有响应头 + 文件内容）
+        len = writev(fd_, iov_ + iovIdx_, iovCnt_ - iovIdx_);
         if (len <= 0) {         // 发送失败
             *saveErrno = errno; // 保存错误码
             break;
         }
-
-        // 如果响应头和文件都已发送完
-        if (iov_[0].iov_len + iov_[1].iov_len == 0) {
+        Advance(len);
+        if (toWrite_ == 0) { // 全部发送完
             break;
         }
-        // 如果发送量超过 iov_[0]（即响应头部分）
-        else if (static_cast<size_t>(len) > iov_[0].iov_len) {
-            // 调整文件内容指针位置，扣掉已发部分
-            iov_[1].iov_base = (uint8_t*)iov_[1].iov_base + (len - iov_[0].iov_len);
-            iov_[1].iov_len -= (len - iov_[0].iov_len);
-
-            // 如果头部还存在数据（理论上不会）
-            if (iov_[0].iov_len) {
-                writeBuff_.RetrieveAll(); // 清空发送缓冲区
-                iov_[0].iov_len = 0;      // 设置头部长度为0
-            }
-        } else {
-            // 如果只发送了头部的一部分
-            iov_[0].iov_base = (uint8_t*)iov_[0].iov_base + len; // 移动指针
-            iov_[0].iov_len -= len;                              // 更新剩余数据
-            writeBuff_.Retrieve(len);                            // 消费缓冲区部分数据
-        }
     } while (isET || ToWriteBytes() > 10240); // ET 模式或数据量较大则继续发送
 
     return len;
 }
 
-bool HttpConn::process() {
-    request_.Init(); // 初始化请求解析对象
+// 追加外部读到的数据（io_uring recv 完成后从 provided buffer 拷入读缓冲区）
+void HttpConn::AppendRead(const char* data, size_t len) {
+    readBuff_.Append(data, len);
+}
 
-    // 无请求数据直接返回 false
-    if (readBuff_.ReadableBytes() <= 0) {
-        return false;
-    }
-    // 解析 HTTP 请求成功
-    else if (request_.parse(readBuff_)) {
-        LOG_DEBUG("%s", request_.path().c_str());
-        // 若解析正常，返回 200 OK
-        response_.Init(srcDir, request_.path(), request_.IsKeepAlive(), 200);
+// 已写出 len 字节：按顺序扣掉写完的 iovec，写了一部分的调整起点；响应头部分同时从 writeBuff_ 中取走
+void HttpConn::Advance(size_t len) {
+    toWrite_ -= len;
+    while (len > 0 && iovIdx_ < iovCnt_) {
+        iovec& iov = iov_[iovIdx_];
+        size_t n = std::min(len, iov.iov_len);
+        bool header = iov.iov_base >= writeBuff_.Peek() && iov.iov_base < writeBuff_.BeginWriteConst();
+        if (header) {
+            writeBuff_.Retrieve(n);
+        }
+        iov.iov_base = (uint8_t*)iov.iov_base + n;
+        iov.iov_len -= n;
+        len -= n;
+        if (iov.iov_len == 0) {
+            iovIdx_++;
+        }
     }
-    // 解析失败返回 400 错误
-    else {
-        response_.Init(srcDir, request_.path(), false, 400);
+    // 已写出的部分写完了，但最后一个响应还有内容：生成下一段（writeBuff_ 此时已全部取走）
+    if (toWrite_ == 0 && generating_) {
+        generating_ = responses_[respCnt_ - 1].Generate(writeBuff_);
+        iov_[0].iov_base = const_cast<char*>(writeBuff_.Peek());
+        iov_[0].iov_len = writeBuff_.ReadableBytes();
+        iovCnt_ = 1;
+        iovIdx_ = 0;
+        toWrite_ = iov_[0].iov_len;
     }
+}
 
-    response_.MakeResponse(writeBuff_); // 生成响应报文（写入 writeBuff_）
+// 格式错误也算"完整"：交给 process() 立即回复 400，而不是一直等下去；
+// 正在转存的请求体有新数据时同样要交给 process() 取走，否则读缓冲区会随请求体增长
+bool HttpConn::IsRequestComplete() {
+    return request_.Check(readBuff_) != HttpRequest::NO_REQUEST ||
+           (request_.BodyStreaming() && readBuff_.ReadableBytes() > 0);
+}
 
-    /* 设置 iov[0] —— 响应头 */
-    iov_[0].iov_base = const_cast<char*>(writeBuff_.Peek());
-    iov_[0].iov_len = writeBuff_.ReadableBytes();
-    iovCnt_ = 1; // 目前只有 header
+bool HttpConn::IsLightRequest() {
+    const char* begin = readBuff_.Peek();
+    size_t len = readBuff_.ReadableBytes();
+    // 只有 POST（登录/注册表单）会走数据库
+    if (!(len > 4 && memcmp(begin, "GET ", 4) == 0) && !(len > 5 && memcmp(begin, "HEAD ", 5) == 0)) {
+        return false;
+    }
+    return IsRequestComplete();
+}
 
-    /* 设置 iov[1] —— 文件内容（若存在） */
-    if (response_.FileLen() > 0 && response_.File()) {
-        iov_[1].iov_base = response_.File();
-        iov_[1].iov_len = response_.FileLen();
-        iovCnt_ = 2; // 发送两段内容
+// 请求的解析进度保存在 request_ 中：请求分多次到达时，每次只扫描新到的数据。
+// 流水线：读缓冲区中已完整的请求按顺序逐个生成响应，响应头依次追加到 writeBuff_，全部生成后再建立 iovec
+// （追加可能使 writeBuff_ 扩容，指向它的指针要等最后再取）
+bool HttpConn::process(bool lightOnly) {
+    // 上一批已全部写出，解除它的文件映射
+    for (int i = 0; i < respCnt_; i++) {
+        responses_[i].UnmapFile();
+    }
+    respCnt_ = 0;
+    arena_.Reset(); // 上一批的表单字段、文件路径等不再使用
+    size_t headLens[MAX_PIPELINE];
+    while (respCnt_ < pipelineDepth && readBuff_.ReadableBytes() > 0) {
+        if (lightOnly && !IsLightRequest()) {
+            break; // 可能要查数据库的请求留在读缓冲区，写完这一批后交给线程池
+        }
+        HttpRequest::HTTP_CODE ret = request_.parse(readBuff_);
+        // 请求还不完整：数据留在读缓冲区，等待下一次读
+        if (ret == HttpRequest::NO_REQUEST) {
+            break;
+        }
+        HttpResponse& response = responses_[respCnt_];
+        // 解析 HTTP 请求成功：依次交给路由表、请求处理回调，都没有处理的按路径返回静态文件（200 OK）
+        if (ret == HttpRequest::GET_REQUEST) {
+            LOG_DEBUG("%s", request_.path().c_str());
+            if (!router.Dispatch(request_, response) && (!requestHandler || !requestHandler(request_, response))) {
+                response.Init(srcDir, request_.path(), request_.IsKeepAlive(), 200);
+            }
+            if (response.IsGenerated() && request_.version() != "1.1") {
+                response.DisableChunked();
+            }
+            keepAlive_ = request_.IsKeepAlive() && response.IsKeepAlive();
+        }
+        // 解析失败返回 400 错误，请求体过大返回 413，转存请求体失败返回 500，不支持的传输编码返回 501
+        // （之后关闭连接，读缓冲区中剩下的数据不再处理）
+        else {
+            int code = ret == HttpRequest::BODY_TOO_LARGE    ? 413
+                       : ret == HttpRequest::INTERNAL_ERROR  ? 500
+                       : ret == HttpRequest::NOT_IMPLEMENTED ? 501
+                                                             : 400;
+            readBuff_.RetrieveAll();
+            request_.Init();
+            keepAlive_ = false;
+            response.Init(srcDir, request_.path(), false, code);
+        }
+        size_t before = writeBuff_.ReadableBytes();
+        response.MakeResponse(writeBuff_); // 生成响应报文（响应头追加到 writeBuff_）
+        generating_ = response.Generate(writeBuff_); // 生成内容的响应：第一段紧跟响应头一起写出
+        headLens[respCnt_++] = writeBuff_.ReadableBytes() - before;
+        if (!keepAlive_) {
+            break; // 写完这个响应就关闭连接，后面的请求不再处理
+        }
+        if (generating_) {
+            break; // 剩下的内容在写的过程中分段生成，后面的请求等它写完再处理
+        }
+    }
+    if (respCnt_ == 0) {
+        return false;
+    }
+
+    // 每个响应：iov 响应头 + iov 文件内容（若存在）
+    const char* head = writeBuff_.Peek();
+    iovCnt_ = iovIdx_ = 0;
+    toWrite_ = 0;
+    for (int i = 0; i < respCnt_; i++) {
+        iov_[iovCnt_].iov_base = const_cast<char*>(head);
+        iov_[iovCnt_].iov_len = headLens[i];
+        iovCnt_++;
+        head += headLens[i];
+        toWrite_ += headLens[i];
+        if (responses_[i].FileLen() > 0 && responses_[i].File()) {
+            iov_[iovCnt_].iov_base = responses_[i].File();
+            iov_[iovCnt_].iov_len = responses_[i].FileLen();
+            iovCnt_++;
+            toWrite_ += responses_[i].FileLen();
+        }
     }
 
-    LOG_DEBUG("filesize:%d, %d  to %d", response_.FileLen(), iovCnt_, ToWriteBytes());
+    LOG_DEBUG("responses:%d, iov:%d, to write:%zu", respCnt_, iovCnt_, toWrite_);
     return true;
 }
@@ -2,19 +2,29 @@
 #define HTTP_CONN_H
 
 #include <sys/types.h>
-#include <sys/uio.h>   // readv / writev 函数，用于分散/聚集IO
-#include <arpa/inet.h> // sockaddr_in，inet_ntoa 等网络相关函数
-#include <stdlib.h>    // atoi() 字符串转数字
-#include <errno.h>     // errno，用于错误码处理
+#include <sys/uio.h>    // readv / writev 函数，用于分散/聚集IO
+#include <arpa/inet.h>  // sockaddr_in / sockaddr_in6，inet_ntop 等网络相关函数
+#include <sys/socket.h> // sockaddr_storage，对端地址与协议族无关
+#include <stdlib.h>     // atoi() 字符串转数字
+#include <errno.h>      // errno，用于错误码处理
+#include <string.h>     // memcmp
+#include <algorithm>    // std::min
+#include <functional>   // 请求处理回调
 
 #include "../log/log.h"          // 日志模块
 #include "../pool/sqlconnpool.h" // MySQL连接池 RAII 管理
 #include "../buffer/buffer.h"    // 自定义缓冲区类
+#include "../buffer/arena.h"     // 每批请求的临时内存
 #include "httprequest.h"         // HTTP 请求处理类
 #include "httpresponse.h"        // HTTP 响应处理类
+#include "httprouter.h"          // 按方法和路径分派的处理函数
 
 class HttpConn {
 public:
+    // 请求处理回调：返回 true 表示已经设置好 resp（通常是 InitGenerated 生成内容的响应），false 时按路径返回静态文件。
+    // 在处理请求的线程中调用，须线程安全
+    typedef std::function<bool(const HttpRequest& req, HttpResponse& resp)> Handler;
+
     // 构造函数 —— 初始化内部变量（fd = -1，连接关闭）
     HttpConn();
 
@@ -22,64 +32,119 @@ public:
     ~HttpConn();
 
     // 初始化 HTTP 连接
-    // 参数：客户端 socket fd 和 IP/端口信息
-    void init(int sockFd, const sockaddr_in& addr);
+    // 参数：客户端 socket fd 和对端地址（AF_INET / AF_INET6 / AF_UNIX）
+    void init(int sockFd, const sockaddr_storage& addr);
 
     // 读客户端数据（非阻塞读）
     // saveErrno 用于保存错误码
     ssize_t read(int* saveErrno);
 
-    // 向客户端写数据（使用 writev 分段发送响应头和文件内容）
+    // 向客户端写数据（一次 writev 发出这一批所有响应的响应头和文件内容）
     ssize_t write(int* saveErrno);
 
+    // 由外部（io_uring）完成的读写：追加已读到的数据 / 按已写出的字节数推进 iov_
+    void AppendRead(const char* data, size_t len);
+    void Advance(size_t len);
+
+    // 待写出的 iovec（从第一个没写完的开始），供 io_uring 提交 writev
+    const struct iovec* WriteIov() const {
+        return iov_ + iovIdx_;
+    }
+    int WriteIovCnt() const {
+        return iovCnt_ - iovIdx_;
+    }
+
     // 主动关闭连接（关闭文件描述符、取消映射、减少用户计数）
-    void Close();
+    // closeFd 为 false 时不调用 close()，由调用方（如 io_uring 的异步 close）负责关闭 fd
+    void Close(bool closeFd = true);
 
     // 获得当前 socket 文件描述符
     int GetFd() const;
 
-    // 获取客户端端口（注意：此端口为网络字节序）
+    // 获取客户端端口（主机字节序，AF_UNIX 连接为 0）
     int GetPort() const;
 
-    // 获取客户端 IP 字符串（格式如 "127.0.0.1"）
+    // 获取客户端 IP 字符串（格式如 "127.0.0.1"，AF_UNIX 连接为 "unix"）
     const char* GetIP() const;
 
-    // 获取客户端地址结构体
-    sockaddr_in GetAddr() const;
+    // 获取客户端地址结构体（按 ss_family 转换为具体类型）
+    const sockaddr_storage& GetAddr() const;
 
     // 处理HTTP请求 —— 解析请求 + 生成响应
-    bool process();
+    // 读缓冲区中有多个完整请求（流水线）时按顺序全部处理（最多 pipelineDepth 个），响应排成一批一起写出；
+    // 返回 false 表示还没有完整的请求。遇到不保持连接的请求（或格式错误）时停止，后面的请求不再处理；
+    // 生成内容的响应也结束这一批，它分段写完之后才处理后面的请求。
+    // lightOnly：在事件循环线程内就地处理时只处理连续的轻量请求，遇到第一个非轻量请求就结束这一批
+    bool process(bool lightOnly = false);
+
+    // 当前这一批的响应个数
+    int ResponseCount() const {
+        return respCnt_;
+    }
+
+    // 读缓冲区中是否已有一个完整的请求（请求头已结束，且 Content-Length 指定的请求体已全部到达），
+    // 或有正在转存的请求体数据等待 process() 取走
+    bool IsRequestComplete();
 
-    // 获取剩余待写数据（iov_两个缓冲区加起来）
-    int ToWriteBytes() {
-        return iov_[0].iov_len + iov_[1].iov_len;
+    // 读缓冲区中是否已有一个完整的轻量请求（GET/HEAD，不会访问数据库），可由事件循环线程就地处理
+    bool IsLightRequest();
+
+    // 读缓冲区中已读到、还没处理的字节数（流水线中后面的请求或不完整的请求）
+    size_t ReadBufferedBytes() const {
+        return readBuff_.ReadableBytes();
+    }
+
+    // 获取剩余待写数据（这一批所有响应加起来）
+    size_t ToWriteBytes() const {
+        return toWrite_;
+    }
+
+    // 连接是否已关闭
+    bool IsClose() const {
+        return isClose_;
     }
 
     // 是否开启长连接（keep-alive）
-    // 取决于请求报文中 Connection 头字段
+    // 取决于这一批最后一个请求报文中的 Connection 头字段
     bool IsKeepAlive() const {
-        return request_.IsKeepAlive();
+        return keepAlive_;
     }
 
+    static const int MAX_PIPELINE = 16; // 每批最多的响应数（流水线深度上限）
+
+    // 注册网站自带页面的路由："/" 和不带 .html 的页面名返回对应的页面，登录/注册表单校验用户后跳转
+    static void AddSiteRoutes(HttpRouter& router);
+
     // static 静态成员 —— 所有连接共享
+    static int pipelineDepth;          // 每批最多处理的请求数（1 ~ MAX_PIPELINE，1 即不合并）
+    static size_t readHighWater;       // ET 模式下一次读事件读到读缓冲区有这么多数据就停下，先处理再读
+    static HttpRouter router;          // 路由表（启动时注册，先于 requestHandler）
+    static Handler requestHandler;     // 请求处理回调（为空时全部按静态文件处理）
     static bool isET;                  // 是否为 ET 模式（边缘触发）
     static const char* srcDir;         // 网站访问根目录
     static std::atomic<int> userCount; // 当前在线连接数（原子类型，保证线程安全）
 
 private:
     int fd_;           // 连接套接字（唯一标识客户端）
-    sockaddr_in addr_; // 客户端 IP + 端口地址结构
+    sockaddr_storage addr_;      // 客户端地址（IPv4 / IPv6 / Unix 域）
+    char ip_[INET6_ADDRSTRLEN]; // init 时格式化好的地址字符串（inet_ntoa 的静态缓冲区在多线程下不安全）
 
     bool isClose_; // 是否已关闭（true表示连接关闭）
 
-    int iovCnt_;          // writev 使用的 iovec 数量（最多2个）
-    struct iovec iov_[2]; // iovec 数组（iov[0] 保存响应头，iov[1] 保存文件内容）
+    int iovCnt_;                         // writev 使用的 iovec 数量（每个响应 1 ~ 2 个）
+    int iovIdx_;                         // 第一个没写完的 iovec
+    struct iovec iov_[2 * MAX_PIPELINE]; // 依次为每个响应的响应头（指向 writeBuff_）和文件内容（若有）
+    size_t toWrite_;                     // 剩余待写字节数
+    bool keepAlive_;                     // 这一批写完后是否保持连接
+    bool generating_;                    // 这一批最后一个响应还有内容没生成（写完当前数据后再生成下一段）
 
     Buffer readBuff_;  // 读缓冲区（用于接收客户端的请求数据）
-    Buffer writeBuff_; // 写缓冲区（用于存放 HTTP 响应头）
+    Buffer writeBuff_; // 写缓冲区（依次存放这一批各响应的响应头）
 
-    HttpRequest request_;   // HTTP 请求解析对象
-    HttpResponse response_; // HTTP 响应构建对象
+    Arena arena_;                            // 这一批请求/响应的临时数据（表单字段、文件路径等），每批开始时回收
+    HttpRequest request_;                    // HTTP 请求解析对象
+    HttpResponse responses_[MAX_PIPELINE];   // 这一批的响应（各自持有文件映射，写完下一批开始时解除）
+    int respCnt_;                            // 这一批的响应个数
 };
 
 #endif // HTTP_CONN_H
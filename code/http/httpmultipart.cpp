@@ -0,0 +1,330 @@
+#include "httpmultipart.h"
+#include <string.h>  // memmem / memcmp / memcpy / memchr
+#include <algorithm> // std::min
+#include <strings.h> // strncasecmp
+
+const size_t MultipartParser::MAX_BOUNDARY;
+const size_t MultipartParser::MAX_HEAD;
+
+void MultipartParser::Reset() {
+    state_ = S_IDLE;
+    error_ = ERR_NONE;
+    sink_ = nullptr;
+    hold_.clear();
+    head_.clear();
+    lineStart_ = true;
+    part_ = Part{-1, {nullptr, 0}, {nullptr, 0}, {nullptr, 0}};
+    inPart_ = false;
+}
+
+bool MultipartParser::Fail_(ERROR_CODE code) {
+    state_ = S_ERROR;
+    error_ = code;
+    return false;
+}
+
+const char* MultipartParser::ErrorStr(ERROR_CODE code) {
+    switch (code) {
+        case ERR_NONE: return "no error";
+        case ERR_DELIMITER: return "invalid multipart delimiter line";
+        case ERR_HEADER: return "invalid multipart part header";
+        case ERR_ABORTED: return "multipart part handler failed";
+    }
+    return "unknown error";
+}
+
+static bool IsSpace(char c) {
+    return c == ' ' || c == '\t';
+}
+
+static HttpParser::StrView Trim(const char* begin, const char* end) {
+    while (begin < end && IsSpace(*begin)) {
+        begin++;
+    }
+    while (end > begin && IsSpace(end[-1])) {
+        end--;
+    }
+    return HttpParser::StrView{begin, static_cast<size_t>(end - begin)};
+}
+
+// 在 "type; k1=v1; k2="v2"" 形式的头部值中取参数 key 的值（名字不区分大小写，带引号时去掉引号）；没有时 data 为 nullptr
+static HttpParser::StrView HeaderParam(HttpParser::StrView value, const char* key) {
+    size_t keyLen = strlen(key);
+    const char* p = value.data;
+    const char* end = value.data + value.len;
+    p = static_cast<const char*>(memchr(p, ';', end - p));
+    while (p && p < end) {
+        p++;
+        while (p < end && IsSpace(*p)) {
+            p++;
+        }
+        const char* eq = p;
+        while (eq < end && *eq != '=' && *eq != ';') {
+            eq++;
+        }
+        bool match = eq < end && *eq == '=' && Trim(p, eq).len == keyLen && strncasecmp(p, key, keyLen) == 0;
+        const char* v = eq < end && *eq == '=' ? eq + 1 : eq;
+        while (v < end && IsSpace(*v)) {
+            v++;
+        }
+        const char* vEnd;
+        if (v < end && *v == '"') { // 带引号：到下一个没有被 '\' 转义的引号为止
+            vEnd = ++v;
+            while (vEnd < end && *vEnd != '"') {
+                vEnd += *vEnd == '\\' && vEnd + 1 < end ? 2 : 1;
+            }
+            if (match) {
+                return HttpParser::StrView{v, static_cast<size_t>(vEnd - v)};
+            }
+            p = static_cast<const char*>(memchr(vEnd, ';', end - vEnd));
+            continue;
+        }
+        vEnd = static_cast<const char*>(memchr(v, ';', end - v));
+        if (match) {
+            return Trim(v, vEnd ? vEnd : end);
+        }
+        p = vEnd;
+    }
+    return HttpParser::StrView{nullptr, 0};
+}
+
+bool MultipartParser::IsFormData(HttpParser::StrView contentType) {
+    static const char TYPE[] = "multipart/form-data";
+    size_t typeLen = sizeof(TYPE) - 1;
+    return contentType.len >= typeLen && strncasecmp(contentType.data, TYPE, typeLen) == 0 &&
+           (contentType.len == typeLen || contentType.data[typeLen] == ';' || IsSpace(contentType.data[typeLen]));
+}
+
+bool MultipartParser::Begin(HttpParser::StrView contentType, Sink sink) {
+    Reset();
+    if (!IsFormData(contentType)) {
+        return false;
+    }
+    HttpParser::StrView boundary = HeaderParam(contentType, "boundary");
+    if (!boundary.data || boundary.len == 0 || boundary.len > MAX_BOUNDARY) {
+        return false;
+    }
+    delim_.assign("\r\n--");
+    delim_.append(boundary.data, boundary.len);
+    sink_ = std::move(sink);
+    hold_.assign("\r\n"); // 请求体开头的分隔符前面没有 CRLF，先假装有
+    state_ = S_PREAMBLE;
+    return true;
+}
+
+// glibc 的 memmem 对短模式用 Horspool 算法（按窗口末尾的字节对跳转，字节对在文件内容中很少碰巧出现在分隔符里，
+// 大多数位置一次跳过分隔符长度减一），长模式用 two-way，最坏情况也是线性的
+size_t MultipartParser::Search(const char* data, size_t len, const char* delim, size_t delimLen) {
+    const void* p = memmem(data, len, delim, delimLen);
+    return p ? static_cast<const char*>(p) - data : len;
+}
+
+bool MultipartParser::Emit_(const char* data, size_t len) {
+    if (state_ != S_DATA || len == 0) {
+        return true; // preamble 丢弃
+    }
+    return sink_(part_, data, len) || Fail_(ERR_ABORTED);
+}
+
+bool MultipartParser::EndPart_() {
+    if (!inPart_) {
+        return true;
+    }
+    inPart_ = false;
+    return sink_(part_, nullptr, 0) || Fail_(ERR_ABORTED);
+}
+
+// 在 S_PREAMBLE / S_DATA 中找分隔符：找到时交出它之前的内容，*used 到分隔符之后，*found 为 true；
+// 没找到时交出除末尾可能是分隔符开头的字节以外的全部，那几个字节存进 hold_，*used 为 len
+bool MultipartParser::Scan_(const char* data, size_t len, size_t* used, bool* found) {
+    *found = false;
+    const char* delim = delim_.data();
+    size_t dl = delim_.size();
+    if (!hold_.empty()) {
+        // 上次留下的字节和这次开头的至多 dl - 1 个字节拼起来，看有没有从 hold_ 中开始的分隔符
+        size_t h = hold_.size();
+        size_t k = std::min(len, dl - 1);
+        char scratch[2 * (MAX_BOUNDARY + 4)];
+        memcpy(scratch, hold_.data(), h);
+        memcpy(scratch + h, data, k);
+        size_t n = h + k;
+        for (size_t p = 0; p < h; p++) {
+            size_t m = std::min(dl, n - p);
+            if (memcmp(scratch + p, delim, m) != 0) {
+                continue;
+            }
+            if (!Emit_(scratch, p)) {
+                return false;
+            }
+            if (m == dl) { // 完整的分隔符
+                hold_.clear();
+                *used = p + dl - h;
+                *found = true;
+                return true;
+            }
+            hold_.assign(scratch + p, n - p); // 这次的数据全部用完了仍是分隔符的开头（k == len）
+            *used = len;
+            return true;
+        }
+        if (!Emit_(hold_.data(), h)) {
+            return false;
+        }
+        hold_.clear();
+    }
+    size_t pos = Search(data, len, delim, dl);
+    if (pos < len) {
+        *used = pos + dl;
+        *found = true;
+        return Emit_(data, pos);
+    }
+    // 末尾不足一个分隔符长度的部分中，从第一个 CR 起若是分隔符的开头就留下
+    size_t q = len >= dl ? len - dl + 1 : 0;
+    while (q < len) {
+        const char* cr = static_cast<const char*>(memchr(data + q, '\r', len - q));
+        if (!cr) {
+            q = len;
+            break;
+        }
+        q = cr - data;
+        if (memcmp(cr, delim, len - q) == 0) {
+            break;
+        }
+        q++;
+    }
+    if (!Emit_(data, q)) {
+        return false;
+    }
+    hold_.assign(data + q, len - q);
+    *used = len;
+    return true;
+}
+
+// head_ 中是 CRLF（或 LF）分隔的头部行，末尾是结束头部的空行
+bool MultipartParser::ParseHead_() {
+    part_ = Part{part_.index + 1, {nullptr, 0}, {nullptr, 0}, {nullptr, 0}};
+    const char* p = head_.data();
+    const char* end = p + head_.size();
+    while (p < end) {
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        const char* next = lineEnd + (lineEnd < end);
+        if (lineEnd > p && lineEnd[-1] == '\r') {
+            lineEnd--;
+        }
+        if (lineEnd > p) {
+            const char* colon = static_cast<const char*>(memchr(p, ':', lineEnd - p));
+            if (!colon || colon == p) {
+                return Fail_(ERR_HEADER);
+            }
+            HttpParser::StrView name = Trim(p, colon);
+            HttpParser::StrView value = Trim(colon + 1, lineEnd);
+            if (name.IEquals("content-disposition")) {
+                part_.name = HeaderParam(value, "name");
+                part_.filename = HeaderParam(value, "filename");
+            } else if (name.IEquals("content-type")) {
+                part_.contentType = value;
+            }
+        }
+        p = next;
+    }
+    inPart_ = true;
+    state_ = S_DATA;
+    return true;
+}
+
+bool MultipartParser::Feed(const char* data, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        char c = data[i];
+        switch (state_) {
+            case S_PREAMBLE:
+            case S_DATA: {
+                size_t used = 0;
+                bool found = false;
+                if (!Scan_(data + i, len - i, &used, &found)) {
+                    return false;
+                }
+                i += used;
+                if (found) {
+                    if (!EndPart_()) {
+                        return false;
+                    }
+                    state_ = S_AFTER;
+                }
+                break;
+            }
+            case S_AFTER:
+                i++;
+                if (c == '-') {
+                    state_ = S_CLOSE;
+                } else if (c == '\r') {
+                    state_ = S_DELIM_LF;
+                } else if (c == '\n') {
+                    head_.clear();
+                    lineStart_ = true;
+                    state_ = S_HEAD;
+                } else if (IsSpace(c)) {
+                    state_ = S_PADDING;
+                } else {
+                    return Fail_(ERR_DELIMITER);
+                }
+                break;
+            case S_CLOSE:
+                if (c != '-') {
+                    return Fail_(ERR_DELIMITER);
+                }
+                state_ = S_DONE;
+                return true; // 之后是 epilogue
+            case S_PADDING:
+                i++;
+                if (c == '\r') {
+                    state_ = S_DELIM_LF;
+                } else if (c == '\n') {
+                    head_.clear();
+                    lineStart_ = true;
+                    state_ = S_HEAD;
+                } else if (!IsSpace(c)) {
+                    return Fail_(ERR_DELIMITER);
+                }
+                break;
+            case S_DELIM_LF:
+                i++;
+                if (c != '\n') {
+                    return Fail_(ERR_DELIMITER);
+                }
+                head_.clear();
+                lineStart_ = true;
+                state_ = S_HEAD;
+                break;
+            case S_HEAD:
+                i++;
+                if (c == '\n') {
+                    if (lineStart_) { // 空行：头部结束，之后是内容
+                        if (!ParseHead_()) {
+                            return false;
+                        }
+                        break;
+                    }
+                    lineStart_ = true;
+                } else if (c != '\r') {
+                    if (static_cast<unsigned char>(c) < 0x20 && c != '\t') {
+                        return Fail_(ERR_HEADER);
+                    }
+                    lineStart_ = false;
+                }
+                head_.push_back(c);
+                if (head_.size() > MAX_HEAD) {
+                    return Fail_(ERR_HEADER);
+                }
+                break;
+            case S_DONE:
+                return true;
+            case S_IDLE:
+            case S_ERROR:
+                return false;
+        }
+    }
+    return state_ != S_ERROR;
+}
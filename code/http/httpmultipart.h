@@ -0,0 +1,104 @@
+#ifndef HTTP_MULTIPART_H
+#define HTTP_MULTIPART_H
+
+#include <stddef.h>   // size_t
+#include <string>     // 分隔符、part 头部
+#include <functional> // 内容回调
+
+#include "httpparser.h" // StrView
+
+// multipart/form-data 请求体的增量解析器（RFC 7578 / RFC 2046 5.1）：
+//   [preamble] "--" boundary CRLF part-headers CRLF part-data CRLF "--" boundary ... "--" boundary "--" [epilogue]
+//   - 可以分多次喂任意长度的数据，分隔符、part 头部被切开也没关系；
+//   - part 的内容不拷贝：在输入中找到分隔符之前的部分直接交给回调，只有末尾可能是分隔符开头的几个字节
+//     （少于分隔符长度）留到下一次，所以内存占用与上传大小无关；
+//   - 分隔符 CRLF "--" boundary 用 memmem 查找（glibc 中为按字节对跳转的 Horspool 算法），普通文件内容中
+//     大多数位置一次跳过将近整个分隔符的长度；
+//   - part 头部只取 Content-Disposition 的 name / filename 和 Content-Type，其余忽略；行尾接受 CRLF 或单独的 LF。
+class MultipartParser {
+public:
+    enum ERROR_CODE {
+        ERR_NONE = 0,
+        ERR_DELIMITER, // 分隔符后面既不是行尾也不是结束标记 "--"
+        ERR_HEADER,    // part 头部含控制字符、缺少冒号或超过 MAX_HEAD
+        ERR_ABORTED,   // 回调返回 false
+    };
+
+    static const size_t MAX_BOUNDARY = 70;  // boundary 最长 70 个字符（RFC 2046）
+    static const size_t MAX_HEAD = 8192;    // 一个 part 的头部最多的字节数
+
+    // 一个 part：视图指向解析器内部保存的头部，在这个 part 结束之前有效；没有对应字段时 data 为 nullptr
+    struct Part {
+        int index;                       // 第几个 part（从 0 开始）
+        HttpParser::StrView name;        // Content-Disposition 的 name
+        HttpParser::StrView filename;    // Content-Disposition 的 filename（文件字段才有）
+        HttpParser::StrView contentType; // Content-Type
+    };
+
+    // 内容回调：一个 part 的内容分一次或多次交出，之后以 len == 0 调用一次表示结束（空的 part 只有这一次）。
+    // 返回 false 时停止解析（ERR_ABORTED）
+    typedef std::function<bool(const Part& part, const char* data, size_t len)> Sink;
+
+    MultipartParser() {
+        Reset();
+    }
+
+    // Content-Type 的值是否为 multipart/form-data（不区分大小写，可以带参数）
+    static bool IsFormData(HttpParser::StrView contentType);
+
+    // 从 Content-Type 的值中取出 boundary（可以带引号）开始新的请求体；不是 multipart/form-data 或没有合法的 boundary 时返回 false
+    bool Begin(HttpParser::StrView contentType, Sink sink);
+    void Reset();
+
+    // 喂入一段请求体，全部消费；出错时返回 false（Failed）。结束标记之后的数据（epilogue）忽略
+    bool Feed(const char* data, size_t len);
+
+    bool Active() const {
+        return state_ != S_IDLE;
+    }
+    bool Done() const {
+        return state_ == S_DONE;
+    }
+    bool Failed() const {
+        return state_ == S_ERROR;
+    }
+    ERROR_CODE Error() const {
+        return error_;
+    }
+    static const char* ErrorStr(ERROR_CODE code);
+
+    // 在 [data, data + len) 中查找 delim，返回位置，没有时返回 len
+    static size_t Search(const char* data, size_t len, const char* delim, size_t delimLen);
+
+private:
+    enum STATE {
+        S_IDLE,       // 没有调用 Begin
+        S_PREAMBLE,   // 第一个分隔符之前，内容丢弃
+        S_AFTER,      // 分隔符之后：行尾开始新的 part，"--" 为结束
+        S_CLOSE,      // 读到结束标记的第一个 '-'
+        S_PADDING,    // 分隔符之后、行尾之前的空白
+        S_DELIM_LF,   // 分隔符行的 CR 之后
+        S_HEAD,       // part 头部，攒在 head_ 中直到空行
+        S_DATA,       // part 内容
+        S_DONE,       // 结束标记之后（epilogue），内容丢弃
+        S_ERROR,
+    };
+
+    bool Fail_(ERROR_CODE code);
+    bool Scan_(const char* data, size_t len, size_t* used, bool* found); // S_PREAMBLE / S_DATA：找分隔符
+    bool Emit_(const char* data, size_t len); // 交出内容（S_PREAMBLE 中丢弃）
+    bool EndPart_();                          // 分隔符结束了上一个 part
+    bool ParseHead_();                        // head_ 收齐后取出字段，开始新的 part
+
+    STATE state_;
+    ERROR_CODE error_;
+    Sink sink_;
+    std::string delim_;  // CRLF "--" boundary
+    std::string hold_;   // 上次末尾可能是分隔符开头的字节（少于 delim_ 的长度）
+    std::string head_;   // 当前 part 的头部
+    bool lineStart_;     // S_HEAD 中当前在行首（读到空行即头部结束）
+    Part part_;
+    bool inPart_;        // 是否有已经开始、还没结束的 part
+};
+
+#endif // HTTP_MULTIPART_H
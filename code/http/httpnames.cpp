@@ -0,0 +1,7 @@
+#include "httpnames.h"
+
+// 键表在运行时按下标取用（ODR-use），需要类外定义
+constexpr const char* HeaderKeys::KEYS[];
+constexpr const char* MethodKeys::KEYS[];
+constexpr const char* MimeKeys::KEYS[];
+constexpr const char* MimeKeys::TYPES[];
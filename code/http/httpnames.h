@@ -0,0 +1,260 @@
+#ifndef HTTP_NAMES_H
+#define HTTP_NAMES_H
+
+#include <stddef.h> // size_t
+#include <stdint.h> // uint32_t
+#include <string.h> // memcpy
+
+// 编译期生成的完美哈希表：把一组固定的字符串（头部名、方法、文件后缀）映射为 0 ~ COUNT-1 的编号。
+//   - 哈希只取长度和首尾各两个字节（不区分大小写时先折叠成小写），拼成一个 32 位字，再做一次带种子的乘法，
+//     高 BITS 位即槽号——不随字符串长度逐字节计算；
+//   - 种子在编译期从 1 开始逐个尝试，取第一个让所有键各占一个槽的（MAX_SEED 以内找不到时编译失败，需加大 BITS；
+//     两个键的长度和首尾字节完全相同时也会编译失败）；
+//   - 槽表（每槽一个字节的编号和键长，编号 0xFF 表示空槽）也在编译期生成。运行时查找 = 一次哈希 + 一次查表
+//     + 长度相同时与候选键比较一次，不分配内存，与键的个数无关。
+// 键表 T 提供：COUNT（键数）、BITS（槽数的位数）、ICASE（是否不区分大小写）、KEYS[COUNT]（长度 2 ~ 255 的键）。
+// 不区分大小写时输入按位或上 0x20 折叠后与键比较：键只能由小写字母、数字和 '-' 组成，输入须是 token
+// （HttpParser 给出的头部名已保证；token 中只有大写字母折叠后会变成别的键字符，所以比较是精确的）
+
+template <int... I>
+struct IndexSeq {};
+template <int N, int... I>
+struct MakeIndexSeq : MakeIndexSeq<N - 1, N - 1, I...> {};
+template <int... I>
+struct MakeIndexSeq<0, I...> {
+    typedef IndexSeq<I...> Type;
+};
+
+// 编译期计算用的函数（单独放一个类：静态成员的初始化式不能调用同一个类中尚未完整定义的 constexpr 函数）
+template <typename T>
+struct PerfectHashGen {
+    static const int SIZE = 1 << T::BITS;
+    static const uint32_t MAX_SEED = 400; // 受 constexpr 递归深度（512）限制
+
+    struct Slots {
+        unsigned char id[SIZE];
+        unsigned char len[SIZE];
+    };
+
+    // 不区分大小写时把字母折叠成小写（token 中的其他字符折叠后可能与别的字符相同，只影响哈希，不影响比较结果）
+    static constexpr uint32_t Byte(char c) {
+        return static_cast<unsigned char>(c) | (T::ICASE ? 0x20u : 0u);
+    }
+    static constexpr uint32_t Hash(uint32_t seed, const char* s, size_t len) {
+        return (((Byte(s[0]) | Byte(s[1]) << 8 | Byte(s[len - 2]) << 16 | Byte(s[len - 1]) << 24) +
+                 static_cast<uint32_t>(len) * 0x9E3779B9u) ^ (seed * 0x85EBCA6Bu)) * 0xC2B2AE35u;
+    }
+    static constexpr uint32_t Slot(uint32_t h) {
+        return h >> (32 - T::BITS);
+    }
+    static constexpr size_t Length(const char* s) {
+        return *s ? 1 + Length(s + 1) : 0;
+    }
+    static constexpr uint32_t KeySlot(uint32_t seed, int k) {
+        return Slot(Hash(seed, T::KEYS[k], Length(T::KEYS[k])));
+    }
+    // 第 i 个键与第 j 个及之后的键都不同槽
+    static constexpr bool Distinct(uint32_t seed, int i, int j) {
+        return j >= T::COUNT || (KeySlot(seed, i) != KeySlot(seed, j) && Distinct(seed, i, j + 1));
+    }
+    static constexpr bool Perfect(uint32_t seed, int i) {
+        return i >= T::COUNT || (Distinct(seed, i, i + 1) && Perfect(seed, i + 1));
+    }
+    static constexpr uint32_t FindSeed(uint32_t seed) {
+        return seed > MAX_SEED ? 0 : Perfect(seed, 0) ? seed : FindSeed(seed + 1);
+    }
+    static constexpr int IdAt(uint32_t seed, int slot, int k) {
+        return k >= T::COUNT ? 0xFF : KeySlot(seed, k) == static_cast<uint32_t>(slot) ? k : IdAt(seed, slot, k + 1);
+    }
+    static constexpr size_t LenAt(int id) {
+        return id == 0xFF ? 0 : Length(T::KEYS[id]);
+    }
+    template <int... I>
+    static constexpr Slots Build(uint32_t seed, IndexSeq<I...>) {
+        return Slots{{static_cast<unsigned char>(IdAt(seed, I, 0))...},
+                     {static_cast<unsigned char>(LenAt(IdAt(seed, I, 0)))...}};
+    }
+};
+
+template <typename T>
+class PerfectHash {
+    typedef PerfectHashGen<T> Gen;
+
+public:
+    static constexpr uint32_t SEED = Gen::FindSeed(1);
+    static_assert(SEED != 0, "no perfect hash seed found, increase BITS");
+    static constexpr typename Gen::Slots SLOTS = Gen::Build(SEED, typename MakeIndexSeq<Gen::SIZE>::Type());
+
+    // [s, s + len) 对应的编号，不在表中时返回 T::COUNT
+    static int Find(const char* s, size_t len) {
+        if (len < 2) {
+            return T::COUNT;
+        }
+        uint32_t slot = Gen::Slot(Gen::Hash(SEED, s, len));
+        if (SLOTS.id[slot] == 0xFF || SLOTS.len[slot] != len) {
+            return T::COUNT;
+        }
+        // 按 8 字节一组比较（不足 8 字节的尾部与前一组重叠），不区分大小写时输入先按位或上 0x20
+        const char* key = T::KEYS[SLOTS.id[slot]];
+        const uint64_t fold = T::ICASE ? 0x2020202020202020ull : 0;
+        if (len >= 8) {
+            for (size_t i = 0; i < len; i += 8) {
+                size_t at = i + 8 <= len ? i : len - 8;
+                if ((Load_(s + at) | fold) != Load_(key + at)) {
+                    return T::COUNT;
+                }
+            }
+        } else {
+            for (size_t i = 0; i < len; i++) {
+                if ((static_cast<unsigned char>(s[i]) | static_cast<unsigned char>(fold)) !=
+                    static_cast<unsigned char>(key[i])) {
+                    return T::COUNT;
+                }
+            }
+        }
+        return SLOTS.id[slot];
+    }
+
+private:
+    static uint64_t Load_(const char* p) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+};
+
+template <typename T>
+constexpr uint32_t PerfectHash<T>::SEED;
+template <typename T>
+constexpr typename PerfectHashGen<T>::Slots PerfectHash<T>::SLOTS;
+
+// 常见的请求头部名（全小写，顺序与 HttpNames::HEADER 一致）
+struct HeaderKeys {
+    static const int COUNT = 44;
+    static const int BITS = 8;
+    static const bool ICASE = true;
+    static constexpr const char* KEYS[COUNT] = {
+        "host", "connection", "content-length", "content-type", "transfer-encoding", "expect", "keep-alive", "te",
+        "trailer", "upgrade", "accept", "accept-charset", "accept-encoding", "accept-language", "authorization",
+        "cache-control", "pragma", "cookie", "user-agent", "referer", "origin", "range", "if-match", "if-none-match",
+        "if-modified-since", "if-unmodified-since", "if-range", "content-encoding", "date", "via", "forwarded",
+        "x-forwarded-for", "x-forwarded-proto", "x-forwarded-host", "x-real-ip", "x-request-id", "proxy-connection",
+        "upgrade-insecure-requests", "dnt", "sec-fetch-site", "sec-fetch-mode", "sec-fetch-dest", "sec-fetch-user",
+        "traceparent",
+    };
+};
+
+// 请求方法（区分大小写，顺序与 HttpNames::METHOD 一致）
+struct MethodKeys {
+    static const int COUNT = 9;
+    static const int BITS = 4;
+    static const bool ICASE = false;
+    static constexpr const char* KEYS[COUNT] = {
+        "GET", "HEAD", "POST", "PUT", "DELETE", "CONNECT", "OPTIONS", "TRACE", "PATCH",
+    };
+};
+
+// 文件后缀 → MIME 类型
+struct MimeKeys {
+    static const int COUNT = 19;
+    static const int BITS = 6;
+    static const bool ICASE = false;
+    static constexpr const char* KEYS[COUNT] = {
+        ".html", ".xml", ".xhtml", ".txt", ".rtf", ".pdf", ".word", ".png", ".gif", ".jpg",
+        ".jpeg", ".au", ".mpeg", ".mpg", ".avi", ".gz", ".tar", ".css", ".js",
+    };
+    static constexpr const char* TYPES[COUNT] = {
+        "text/html", "text/xml", "application/xhtml+xml", "text/plain", "application/rtf", "application/pdf",
+        "application/nsword", "image/png", "image/gif", "image/jpeg", "image/jpeg", "audio/basic", "video/mpeg",
+        "video/mpeg", "video/x-msvideo", "application/x-gzip", "application/x-tar", "text/css", "text/javascript",
+    };
+};
+
+// 头部名、方法、文件后缀的编号查找（见 PerfectHash）
+class HttpNames {
+public:
+    enum HEADER {
+        H_HOST = 0,
+        H_CONNECTION,
+        H_CONTENT_LENGTH,
+        H_CONTENT_TYPE,
+        H_TRANSFER_ENCODING,
+        H_EXPECT,
+        H_KEEP_ALIVE,
+        H_TE,
+        H_TRAILER,
+        H_UPGRADE,
+        H_ACCEPT,
+        H_ACCEPT_CHARSET,
+        H_ACCEPT_ENCODING,
+        H_ACCEPT_LANGUAGE,
+        H_AUTHORIZATION,
+        H_CACHE_CONTROL,
+        H_PRAGMA,
+        H_COOKIE,
+        H_USER_AGENT,
+        H_REFERER,
+        H_ORIGIN,
+        H_RANGE,
+        H_IF_MATCH,
+        H_IF_NONE_MATCH,
+        H_IF_MODIFIED_SINCE,
+        H_IF_UNMODIFIED_SINCE,
+        H_IF_RANGE,
+        H_CONTENT_ENCODING,
+        H_DATE,
+        H_VIA,
+        H_FORWARDED,
+        H_X_FORWARDED_FOR,
+        H_X_FORWARDED_PROTO,
+        H_X_FORWARDED_HOST,
+        H_X_REAL_IP,
+        H_X_REQUEST_ID,
+        H_PROXY_CONNECTION,
+        H_UPGRADE_INSECURE_REQUESTS,
+        H_DNT,
+        H_SEC_FETCH_SITE,
+        H_SEC_FETCH_MODE,
+        H_SEC_FETCH_DEST,
+        H_SEC_FETCH_USER,
+        H_TRACEPARENT,
+        H_UNKNOWN, // 不在表中的头部名
+    };
+
+    enum METHOD {
+        M_GET = 0,
+        M_HEAD,
+        M_POST,
+        M_PUT,
+        M_DELETE,
+        M_CONNECT,
+        M_OPTIONS,
+        M_TRACE,
+        M_PATCH,
+        M_UNKNOWN,
+    };
+
+    static HEADER Header(const char* name, size_t len) { // 不区分大小写
+        return static_cast<HEADER>(PerfectHash<HeaderKeys>::Find(name, len));
+    }
+    static METHOD Method(const char* method, size_t len) {
+        return static_cast<METHOD>(PerfectHash<MethodKeys>::Find(method, len));
+    }
+    // suffix 含开头的 '.'，不认识的后缀返回 nullptr
+    static const char* MimeType(const char* suffix, size_t len) {
+        int id = PerfectHash<MimeKeys>::Find(suffix, len);
+        return id < MimeKeys::COUNT ? MimeKeys::TYPES[id] : nullptr;
+    }
+
+    static const char* HeaderName(HEADER id) {
+        return id < H_UNKNOWN ? HeaderKeys::KEYS[id] : "";
+    }
+    static const char* MethodName(METHOD id) {
+        return id < M_UNKNOWN ? MethodKeys::KEYS[id] : "";
+    }
+};
+
+static_assert(HttpNames::H_UNKNOWN == HeaderKeys::COUNT, "HEADER and HeaderKeys::KEYS out of sync");
+static_assert(HttpNames::M_UNKNOWN == MethodKeys::COUNT, "METHOD and MethodKeys::KEYS out of sync");
+
+#endif // HTTP_NAMES_H
@@ -0,0 +1,240 @@
+#include "httpparser.h"
+#include "httpscan.h" // 字段扫描（SIMD）
+
+void HttpParser::Reset() {
+    state_ = S_START;
+    pos_ = mark_ = 0;
+    base_ = nullptr;
+    method_ = target_ = version_ = Span{0, 0};
+    versionMajor_ = versionMinor_ = 0;
+    headerCount_ = 0;
+    memset(first_, 0, sizeof(first_));
+    headLen_ = 0;
+    error_ = ERR_NONE;
+    errorPos_ = 0;
+}
+
+HttpParser::RESULT HttpParser::Fail_(ERROR_CODE code, const char* data, const char* pos) {
+    state_ = S_ERROR;
+    error_ = code;
+    errorPos_ = pos - data;
+    return PARSE_ERROR;
+}
+
+// 数据不够：记下停下的位置，下次从这里继续；已经超过上限的直接判错，不再等下去
+HttpParser::RESULT HttpParser::Incomplete_(const char* data, const char* pos, size_t len) {
+    pos_ = pos - data;
+    if (len > MAX_HEAD_SIZE) {
+        return Fail_(ERR_HEAD_TOO_LARGE, data, data + MAX_HEAD_SIZE);
+    }
+    return PARSE_INCOMPLETE;
+}
+
+HttpParser::RESULT HttpParser::Parse(const char* data, size_t len) {
+    base_ = data;
+    if (state_ == S_DONE) {
+        return PARSE_OK;
+    }
+    if (state_ == S_ERROR) {
+        return PARSE_ERROR;
+    }
+    const char* p = data + pos_;
+    const char* end = data + len;
+
+    // 每个状态处理完把 p 推进到下一个字段，数据不够时在当前状态停下（字段起点在 mark_ 中）
+    while (true) {
+        switch (state_) {
+            case S_START: // 请求行之前的空行（如上一个请求体后面多出的 CRLF）
+                if (p < end && *p == '\n') {
+                    p++;
+                } else if (end - p >= 2 && p[0] == '\r' && p[1] == '\n') {
+                    p += 2;
+                } else if (p == end || (end - p == 1 && *p == '\r')) {
+                    return Incomplete_(data, p, len);
+                } else {
+                    mark_ = p - data;
+                    state_ = S_METHOD;
+                }
+                break;
+
+            case S_METHOD: // 方法：1 个以上 token 字符，后跟一个空格
+                p += HttpScan::Token(p, end);
+                if (p == end) {
+                    return Incomplete_(data, p, len);
+                }
+                if (p == data + mark_ || *p != ' ') {
+                    return Fail_(ERR_METHOD, data, p);
+                }
+                method_ = Span{mark_, static_cast<size_t>(p - data) - mark_};
+                mark_ = ++p - data;
+                state_ = S_TARGET;
+                break;
+
+            case S_TARGET: // 请求目标：1 个以上可见字符，后跟一个空格
+                p += HttpScan::Target(p, end);
+                if (p == end) {
+                    return Incomplete_(data, p, len);
+                }
+                if (p == data + mark_ || *p != ' ') {
+                    return Fail_(ERR_TARGET, data, p);
+                }
+                target_ = Span{mark_, static_cast<size_t>(p - data) - mark_};
+                mark_ = ++p - data;
+                state_ = S_VERSION;
+                break;
+
+            case S_VERSION: { // "HTTP/" DIGIT "." DIGIT
+                static const char PREFIX[] = "HTTP/";
+                for (size_t i = p - data - mark_; i < 8; i++, p++) {
+                    if (p == end) {
+                        return Incomplete_(data, p, len);
+                    }
+                    bool ok = i < 5 ? *p == PREFIX[i] : i == 6 ? *p == '.' : (*p >= '0' && *p <= '9');
+                    if (!ok) {
+                        return Fail_(ERR_VERSION, data, p);
+                    }
+                }
+                version_ = Span{mark_ + 5, 3};
+                versionMajor_ = p[-3] - '0';
+                versionMinor_ = p[-1] - '0';
+                state_ = S_LINE_END;
+                break;
+            }
+
+            case S_LINE_END: // 请求行结尾：CRLF 或 LF
+                if (p == end || (*p == '\r' && p + 1 == end)) {
+                    return Incomplete_(data, p, len);
+                }
+                if (*p == '\r') {
+                    if (*++p != '\n') {
+                        return Fail_(ERR_LINE_END, data, p);
+                    }
+                } else if (*p != '\n') {
+                    return Fail_(ERR_VERSION, data, p);
+                }
+                p++;
+                state_ = S_HEADER_START;
+                break;
+
+            case S_HEADER_START: // 头部行开头，空行表示头部结束
+                if (p == end || (*p == '\r' && p + 1 == end)) {
+                    return Incomplete_(data, p, len);
+                }
+                if (*p == '\r' || *p == '\n') {
+                    if (*p == '\r' && *++p != '\n') {
+                        return Fail_(ERR_LINE_END, data, p);
+                    }
+                    p++;
+                    headLen_ = p - data;
+                    if (headLen_ > MAX_HEAD_SIZE) {
+                        return Fail_(ERR_HEAD_TOO_LARGE, data, data + MAX_HEAD_SIZE);
+                    }
+                    pos_ = headLen_;
+                    state_ = S_DONE;
+                    return PARSE_OK;
+                }
+                if (*p == ' ' || *p == '\t') {
+                    return Fail_(ERR_OBS_FOLD, data, p);
+                }
+                if (headerCount_ == MAX_HEADERS) {
+                    return Fail_(ERR_TOO_MANY_HEADERS, data, p);
+                }
+                mark_ = p - data;
+                state_ = S_HEADER_NAME;
+                break;
+
+            case S_HEADER_NAME: { // 头部名：1 个以上 token 字符，紧跟冒号（冒号前不允许空白）
+                p += HttpScan::Token(p, end);
+                if (p == end) {
+                    return Incomplete_(data, p, len);
+                }
+                if (p == data + mark_ || *p != ':') {
+                    return Fail_(ERR_HEADER_NAME, data, p);
+                }
+                HeaderSpan& h = headers_[headerCount_];
+                h.name = Span{mark_, static_cast<size_t>(p - data) - mark_};
+                h.id = HttpNames::Header(data + mark_, h.name.len); // 名字读完即定编号，之后按编号查找
+                if (h.id != HttpNames::H_UNKNOWN && !first_[h.id]) {
+                    first_[h.id] = static_cast<unsigned char>(headerCount_ + 1);
+                }
+                p++;
+                state_ = S_VALUE_START;
+                break;
+            }
+
+            case S_VALUE_START: // 跳过头部值的前导空白
+                while (p < end && (*p == ' ' || *p == '\t')) {
+                    p++;
+                }
+                if (p == end) {
+                    return Incomplete_(data, p, len);
+                }
+                mark_ = p - data;
+                state_ = S_VALUE;
+                break;
+
+            case S_VALUE: { // 头部值：扫描到行尾，再去掉尾部空白
+                p += HttpScan::Value(p, end);
+                if (p == end || (*p == '\r' && p + 1 == end)) {
+                    return Incomplete_(data, p, len);
+                }
+                const char* start = data + mark_;
+                const char* valueEnd = p;
+                while (valueEnd > start && (valueEnd[-1] == ' ' || valueEnd[-1] == '\t')) {
+                    valueEnd--;
+                }
+                if (*p == '\r') {
+                    if (*++p != '\n') {
+                        return Fail_(ERR_LINE_END, data, p);
+                    }
+                } else if (*p != '\n') {
+                    return Fail_(ERR_HEADER_VALUE, data, p);
+                }
+                p++;
+                headers_[headerCount_++].value = Span{mark_, static_cast<size_t>(valueEnd - start)};
+                state_ = S_HEADER_START;
+                break;
+            }
+
+            default: return PARSE_ERROR;
+        }
+    }
+}
+
+// 表中的名字按编号直接取，表外的名字只需和同样不在表中的头部比较
+HttpParser::StrView HttpParser::Find(const char* name) const {
+    HttpNames::HEADER id = HttpNames::Header(name, strlen(name));
+    if (id != HttpNames::H_UNKNOWN) {
+        return Find(id);
+    }
+    for (size_t i = 0; i < headerCount_; i++) {
+        if (headers_[i].id == HttpNames::H_UNKNOWN && View_(headers_[i].name).IEquals(name)) {
+            return View_(headers_[i].value);
+        }
+    }
+    return StrView{nullptr, 0};
+}
+
+size_t HttpParser::Count(HttpNames::HEADER id) const {
+    size_t n = 0;
+    for (size_t i = 0; i < headerCount_; i++) {
+        n += headers_[i].id == id;
+    }
+    return n;
+}
+
+const char* HttpParser::ErrorStr(ERROR_CODE code) {
+    switch (code) {
+        case ERR_NONE: return "no error";
+        case ERR_METHOD: return "invalid method";
+        case ERR_TARGET: return "invalid request target";
+        case ERR_VERSION: return "invalid http version";
+        case ERR_LINE_END: return "CR not followed by LF";
+        case ERR_HEADER_NAME: return "invalid header name";
+        case ERR_HEADER_VALUE: return "invalid header value";
+        case ERR_OBS_FOLD: return "obsolete line folding";
+        case ERR_TOO_MANY_HEADERS: return "too many headers";
+        case ERR_HEAD_TOO_LARGE: return "request head too large";
+    }
+    return "unknown error";
+}
@@ -0,0 +1,177 @@
+#ifndef HTTP_PARSER_H
+#define HTTP_PARSER_H
+
+#include <stddef.h>  // size_t
+#include <string.h>  // memcmp / strlen
+#include <strings.h> // strncasecmp
+#include <string>    // StrView::ToString
+
+#include "httpnames.h"
+
+// HTTP/1.x 请求头解析器（请求行 + 头部 + 结尾空行），手写状态机，不用正则、不分配内存：
+//   - 直接扫描调用方给出的 [data, data + len)（通常是 Buffer::Peek()），不拷贝任何一行；
+//   - 方法、请求目标、版本和每个头部的名字/值都以 StrView（指针 + 长度）给出，指向原始数据；
+//   - 头部存放在对象内固定大小的数组中（最多 MAX_HEADERS 个）；头部名读完时即查 HttpNames 的完美哈希表得到编号，
+//     常见头部按编号 O(1) 查找，表外的头部名才逐个比较；
+//   - 可以分多次喂数据：数据不完整时记下状态和扫描到的偏移，下次从停下的地方继续（包括字段中间），
+//     每个字节只扫描一次。内部只保存相对 data 的偏移，所以两次调用之间 data 可以搬家（如 Buffer 整理空间），
+//     只要已给出的字节内容和顺序不变；解析完成前不要从数据开头取走任何字节；
+//   - 各字段由 HttpScan 整块扫描（AVX2 / SSE4.2），找分隔符的同时校验字符；
+//   - 语法按 RFC 9112：方法和头部名必须是 token，请求目标不能含空白和控制字符，版本必须是 HTTP/d.d，
+//     头部值不能含控制字符，不接受 obs-fold（以空白开头的续行）。出错时给出错误类型和出错字节相对 data 的偏移。
+// 行尾接受 CRLF，也接受单独的 LF（RFC 9112 2.2）；单独的 CR 是错误。请求行之前的空行会被跳过。
+class HttpParser {
+public:
+    // 指向原始数据的字符串视图（C++11 没有 std::string_view）
+    struct StrView {
+        const char* data;
+        size_t len;
+
+        bool Empty() const {
+            return len == 0;
+        }
+        bool Equals(const char* s) const { // 区分大小写
+            size_t n = strlen(s);
+            return n == len && memcmp(data, s, n) == 0;
+        }
+        bool IEquals(const char* s) const { // 不区分大小写（头部名、Connection 等取值）
+            size_t n = strlen(s);
+            return n == len && strncasecmp(data, s, n) == 0;
+        }
+        std::string ToString() const {
+            return std::string(data, len);
+        }
+    };
+
+    struct Header {
+        StrView name;         // 头部名（原样，比较时不区分大小写）
+        StrView value;        // 头部值（已去掉首尾空白）
+        HttpNames::HEADER id; // 头部名的编号，不在表中为 H_UNKNOWN
+    };
+
+    enum RESULT {
+        PARSE_OK,         // 头部完整且合法
+        PARSE_INCOMPLETE, // 数据还不够一个完整的头部（目前为止没有错误）
+        PARSE_ERROR,      // 语法错误，见 Error() / ErrorPos()
+    };
+
+    enum ERROR_CODE {
+        ERR_NONE = 0,
+        ERR_METHOD,           // 方法为空或含非 token 字符
+        ERR_TARGET,           // 请求目标为空或含空白/控制字符
+        ERR_VERSION,          // 版本不是 HTTP/d.d
+        ERR_LINE_END,         // CR 后面不是 LF
+        ERR_HEADER_NAME,      // 头部名为空、含非 token 字符（包括冒号前的空白），或缺少冒号
+        ERR_HEADER_VALUE,     // 头部值含控制字符
+        ERR_OBS_FOLD,         // 以空白开头的续行（obs-fold）
+        ERR_TOO_MANY_HEADERS, // 头部超过 MAX_HEADERS 个
+        ERR_HEAD_TOO_LARGE,   // 头部超过 MAX_HEAD_SIZE 字节
+    };
+
+    static const size_t MAX_HEADERS = 64;          // 单个请求最多的头部数
+    static const size_t MAX_HEAD_SIZE = 64 * 1024; // 请求行 + 头部的最大字节数
+
+    HttpParser() {
+        Reset();
+    }
+
+    void Reset(); // 清空上一次的结果，开始解析新的请求
+
+    // 解析 [data, data + len) 开头的请求头，从上次停下的地方继续；len 只能增加。
+    // PARSE_OK 时 HeadLength() 为头部（含结尾空行）的字节数；完成或出错后再调用直接返回同样的结果
+    RESULT Parse(const char* data, size_t len);
+
+    // 头部被原样拷贝到 to 处后，让所有视图改为指向 to（原缓冲区随后可以被覆盖）
+    void Rebase(const char* to) {
+        base_ = to;
+    }
+
+    // 以下视图指向最近一次 Parse / Rebase 给出的数据
+    StrView Method() const {
+        return View_(method_);
+    }
+    StrView Target() const {
+        return View_(target_);
+    }
+    StrView Version() const { // "1.1"（不含 "HTTP/"）
+        return View_(version_);
+    }
+    int VersionMajor() const {
+        return versionMajor_;
+    }
+    int VersionMinor() const {
+        return versionMinor_;
+    }
+    size_t HeaderCount() const {
+        return headerCount_;
+    }
+    Header HeaderAt(size_t i) const {
+        return Header{View_(headers_[i].name), View_(headers_[i].value), headers_[i].id};
+    }
+    StrView Find(const char* name) const; // 按名字查找（不区分大小写），没有时 data 为 nullptr
+    StrView Find(HttpNames::HEADER id) const { // 按编号查找第一个同名头部，没有时 data 为 nullptr
+        return id < HttpNames::H_UNKNOWN && first_[id] ? View_(headers_[first_[id] - 1].value) : StrView{nullptr, 0};
+    }
+    size_t Count(HttpNames::HEADER id) const; // 同名头部出现的次数
+    size_t HeadLength() const {
+        return headLen_;
+    }
+
+    ERROR_CODE Error() const {
+        return error_;
+    }
+    size_t ErrorPos() const { // 出错字节相对 data 的偏移
+        return errorPos_;
+    }
+    static const char* ErrorStr(ERROR_CODE code);
+
+private:
+    // 解析进度：下一步要扫描的内容
+    enum STATE {
+        S_START,        // 请求行之前的空行
+        S_METHOD,       // 方法
+        S_TARGET,       // 请求目标
+        S_VERSION,      // 版本
+        S_LINE_END,     // 请求行结尾
+        S_HEADER_START, // 头部行开头（或结尾空行）
+        S_HEADER_NAME,  // 头部名
+        S_VALUE_START,  // 头部值前的空白
+        S_VALUE,        // 头部值
+        S_DONE,
+        S_ERROR,
+    };
+
+    struct Span { // 相对 base_ 的偏移
+        size_t off;
+        size_t len;
+    };
+    struct HeaderSpan {
+        Span name;
+        Span value;
+        HttpNames::HEADER id;
+    };
+
+    StrView View_(const Span& s) const {
+        return StrView{base_ + s.off, s.len};
+    }
+    RESULT Fail_(ERROR_CODE code, const char* data, const char* pos);
+    RESULT Incomplete_(const char* data, const char* pos, size_t len);
+
+    STATE state_;
+    size_t pos_;  // 下一个要扫描的字节
+    size_t mark_; // 当前字段的起始位置
+    const char* base_;
+    Span method_;
+    Span target_;
+    Span version_;
+    int versionMajor_;
+    int versionMinor_;
+    HeaderSpan headers_[MAX_HEADERS];
+    size_t headerCount_;
+    unsigned char first_[HttpNames::H_UNKNOWN]; // 每个编号第一次出现的头部下标 + 1（0 表示没有）
+    size_t headLen_;
+    ERROR_CODE error_;
+    size_t errorPos_;
+};
+
+#endif // HTTP_PARSER_H
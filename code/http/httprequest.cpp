@@ -1,15 +1,16 @@
 #include "httprequest.h"
-
-// 不带.html 的 URL，如果用户只访问 /index，就自动变成 /index.html
-const std::unordered_set<std::string> HttpRequest::DEFAULT_HTML{
-    "/index", "/register", "/login", "/welcome", "/video", "/picture",
-};
-
-// 判断访问 .html 页面类型
-const std::unordered_map<std::string, int> HttpRequest::DEFAULT_HTML_TAG{
-    {"/register.html", 0}, // 0 = 注册页面
-    {"/login.html", 1},    // 1 = 登录页面
-};
+#include <ctype.h>  // isxdigit
+#include <fcntl.h>  // O_TMPFILE
+#include <string.h> // memchr
+#include <unistd.h> // write / close
+
+const size_t HttpRequest::BODY_CHUNK;
+const size_t HttpRequest::MAX_UPLOADS;
+size_t HttpRequest::maxBodySize = 64 << 20;
+size_t HttpRequest::bodyMemLimit = 64 << 10;
+std::string HttpRequest::bodyTempDir = "/tmp";
+HttpRequest::BodyHandler HttpRequest::bodyHandler;
+HttpRequest::PartHandler HttpRequest::partHandler;
 
 // 16进制转化为10进制（%20 表示空格' '）
 int HttpRequest::ConverHex(char ch) {
@@ -22,69 +23,428 @@ int HttpRequest::ConverHex(char ch) {
     return ch;
 }
 
+HttpRequest::~HttpRequest() {
+    if (bodyFd_ >= 0) {
+        close(bodyFd_);
+    }
+    for (const UploadFile& file : uploads_) {
+        close(file.fd);
+    }
+}
+
 // 初始化请求解析状态（可用于复用 HttpRequest 对象）
 void HttpRequest::Init() {
-    method_ = path_ = version_ = body_ = ""; // 清空请求方式、URL、版本、请求体
-    state_ = REQUEST_LINE;                   // 从解析请求行开始
-    header_.clear();                         // 清空头部键值对
-    post_.clear();                           // 清空 POST 表单数据
+    method_.clear(); // 清空请求方式、URL、版本、请求体（保留容量，下个请求复用）
+    path_.clear();
+    version_.clear();
+    body_.clear();
+    head_.clear();
+    parser_.Reset();
+    methodId_ = HttpNames::M_UNKNOWN;
+    keepAlive_ = false;
+    msgLen_ = 0;
+    bodyLen_ = bodyLeft_ = 0;
+    spooling_ = false;
+    chunked_.Reset();
+    if (bodyFd_ >= 0) {
+        close(bodyFd_); // 匿名临时文件关闭即删除
+        bodyFd_ = -1;
+    }
+    bodyError_ = INTERNAL_ERROR;
+    multipart_.Reset();
+    partIndex_ = -1;
+    fieldData_.clear();
+    fields_.clear();
+    for (const UploadFile& file : uploads_) {
+        close(file.fd); // 匿名临时文件关闭即删除
+    }
+    uploads_.clear();
+    state_ = REQUEST_LINE; // 从解析请求行开始
+    post_.clear();         // 清空 POST 表单数据
 }
 
 // 判断是否为长连接（keep-alive）
 bool HttpRequest::IsKeepAlive() const {
-    if (header_.count("Connection") == 1) {                                             // 是否存在 Connection 头
-        return header_.find("Connection")->second == "keep-alive" && version_ == "1.1"; // HTTP1.1 默认支持长连接
+    return keepAlive_;
+}
+
+// 推进请求头解析；头部完整后按 Content-Length 确定整个请求的长度（没有 Content-Length 则没有请求体）。
+// 头部完整时就拷贝到 head_ 并取出请求行：请求体转存期间 bodyHandler 要用到方法、路径和请求头
+HttpRequest::HTTP_CODE HttpRequest::Frame_(const Buffer& buff) {
+    if (state_ == FINISH) {
+        Init(); // 上一个请求已经取走，开始新的请求
     }
-    return false;
+    if (state_ == REQUEST_LINE || state_ == HEADERS) {
+        HttpParser::RESULT ret = parser_.Parse(buff.Peek(), buff.ReadableBytes());
+        if (ret == HttpParser::PARSE_ERROR) {
+            LOG_WARN("Bad request: %s at byte %zu", HttpParser::ErrorStr(parser_.Error()), parser_.ErrorPos());
+            return BAD_REQUEST;
+        }
+        if (ret == HttpParser::PARSE_INCOMPLETE) {
+            state_ = HEADERS;
+            return NO_REQUEST;
+        }
+        size_t bodyLen = 0;
+        HttpParser::StrView cl = parser_.Find(HttpNames::H_CONTENT_LENGTH);
+        // 重复的 Content-Length 与前置代理对请求边界的理解可能不同（请求走私），直接拒绝
+        if (cl.data && parser_.Count(HttpNames::H_CONTENT_LENGTH) > 1) {
+            LOG_WARN("Bad request: duplicate Content-Length");
+            return BAD_REQUEST;
+        }
+        if (cl.data) {
+            if (cl.len == 0 || cl.len > 18) { // 18 位十进制数不会溢出 size_t
+                LOG_WARN("Bad request: invalid Content-Length");
+                return BAD_REQUEST;
+            }
+            for (size_t i = 0; i < cl.len; i++) {
+                if (cl.data[i] < '0' || cl.data[i] > '9') {
+                    LOG_WARN("Bad request: invalid Content-Length");
+                    return BAD_REQUEST;
+                }
+                bodyLen = bodyLen * 10 + (cl.data[i] - '0');
+            }
+        }
+        // Transfer-Encoding 只支持单独的 chunked；同时带 Content-Length 或重复的 Transfer-Encoding 时，
+        // 前置代理和这里对请求边界的理解可能不同（请求走私），直接拒绝
+        bool chunked = false;
+        HttpParser::StrView te = parser_.Find(HttpNames::H_TRANSFER_ENCODING);
+        if (te.data) {
+            if (cl.data || parser_.Count(HttpNames::H_TRANSFER_ENCODING) > 1) {
+                LOG_WARN("Bad request: ambiguous body length");
+                return BAD_REQUEST;
+            }
+            if (!te.IEquals("chunked")) {
+                LOG_WARN("Unsupported Transfer-Encoding: %.*s", static_cast<int>(te.len), te.data);
+                return NOT_IMPLEMENTED;
+            }
+            chunked = true;
+        }
+        if (bodyLen > maxBodySize) {
+            LOG_WARN("Request body too large: %zu > %zu", bodyLen, maxBodySize);
+            return BODY_TOO_LARGE;
+        }
+
+        // 请求头拷贝到 head_ 并让视图指向它：读缓冲区取走数据后会被覆盖或移动
+        size_t headLen = parser_.HeadLength();
+        head_.assign(buff.Peek(), headLen);
+        parser_.Rebase(head_.data());
+        HttpParser::StrView method = parser_.Method();
+        HttpParser::StrView target = parser_.Target();
+        HttpParser::StrView version = parser_.Version();
+        method_.assign(method.data, method.len);
+        methodId_ = HttpNames::Method(method.data, method.len);
+        path_.assign(target.data, target.len);
+        version_.assign(version.data, version.len);
+        HttpParser::StrView conn = parser_.Find(HttpNames::H_CONNECTION);
+        keepAlive_ = conn.data && conn.IEquals("keep-alive") && version_ == "1.1";
+
+        // multipart/form-data 边到达边解析（无论请求体在内存中还是转存），boundary 不合法时不必等请求体
+        HttpParser::StrView type = parser_.Find(HttpNames::H_CONTENT_TYPE);
+        if (!bodyHandler && type.data && MultipartParser::IsFormData(type)) {
+            auto sink = [this](const MultipartParser::Part& part, const char* data, size_t len) {
+                return OnPart_(part, data, len);
+            };
+            if (!multipart_.Begin(type, sink)) {
+                LOG_WARN("Bad request: invalid multipart boundary");
+                return BAD_REQUEST;
+            }
+        }
+
+        bodyLen_ = bodyLeft_ = bodyLen;
+        if (chunked) {
+            msgLen_ = headLen; // 长度事先未知：头部留给 parse 取走，请求体边到达边解码
+            state_ = BODY_CHUNKED;
+            return NO_REQUEST;
+        }
+        if (bodyLen > bodyMemLimit) {
+            msgLen_ = headLen; // 只有头部留在读缓冲区等 parse 取走，请求体边到达边转存
+            state_ = BODY_STREAM;
+            return NO_REQUEST;
+        }
+        msgLen_ = headLen + bodyLen;
+        state_ = BODY;
+    }
+    if (BodyStreaming()) {
+        return NO_REQUEST;
+    }
+    return buff.ReadableBytes() >= msgLen_ ? GET_REQUEST : NO_REQUEST;
 }
 
-// 解析 HTTP 请求（入口函数）
-bool HttpRequest::parse(Buffer& buff) {
-    const char CRLF[] = "\r\n"; // HTTP 行结束符
+HttpRequest::HTTP_CODE HttpRequest::Check(const Buffer& buff) {
+    return Frame_(buff);
+}
 
+// 解析 HTTP 请求（入口函数）
+HttpRequest::HTTP_CODE HttpRequest::parse(Buffer& buff) {
     // 没有数据可读
     if (buff.ReadableBytes() <= 0) {
-        return false;
+        return NO_REQUEST;
+    }
+    HTTP_CODE ret = Frame_(buff);
+    if (state_ == BODY_STREAM) {
+        return StreamBody_(buff);
+    }
+    if (state_ == BODY_CHUNKED) {
+        return DecodeBody_(buff);
+    }
+    if (ret != GET_REQUEST) {
+        return ret;
     }
 
-    // 只要有数据可读，并且解析没有完成（FINISH），就一直处理
-    while (buff.ReadableBytes() && state_ != FINISH) {
-        // 查找 "\r\n" 行结束符
-        const char* lineEnd = std::search(buff.Peek(), buff.BeginWriteConst(), CRLF, CRLF + 2);
-        // 获取这一行字符串（不包含 "\r\n"）
-        std::string line(buff.Peek(), lineEnd);
+    size_t headLen = parser_.HeadLength();
+    body_.assign(buff.Peek() + headLen, msgLen_ - headLen);
+    buff.Retrieve(msgLen_);
+    state_ = FINISH;
 
-        switch (state_) {
-            case REQUEST_LINE:
-                if (!ParseRequestLine_(line)) { // 解析请求行
-                    return false;
-                }
-                ParsePath_(); // 处理 URL 文件路径
-                break;
-            case HEADERS:
-                ParseHeader_(line);              // 解析请求头
-                if (buff.ReadableBytes() <= 2) { // 如果只剩下 "\r\n"，说明头部结束
-                    state_ = FINISH;
-                }
-                break;
-            case BODY:
-                ParseBody_(line); // 解析请求体
-                break;
-            default: break;
+    HTTP_CODE post = ParsePost_(); // 解析 POST 表单
+    if (post != GET_REQUEST) {
+        return post;
+    }
+    LOG_DEBUG("[%s], [%s], [%s]", method_.c_str(), path_.c_str(), version_.c_str());
+    return GET_REQUEST;
+}
+
+// 取走读缓冲区中已到达的请求体（第一次调用时先取走头部），按 BODY_CHUNK 分段转存；收齐后返回 GET_REQUEST。
+// 转存的 urlencoded 请求体不做表单解析（登录/注册表单远小于 bodyMemLimit），multipart 则在转存的同时解析
+HttpRequest::HTTP_CODE HttpRequest::StreamBody_(Buffer& buff) {
+    if (!spooling_ && !BeginSpool_()) {
+        return INTERNAL_ERROR;
+    }
+    buff.Retrieve(msgLen_);
+    msgLen_ = 0;
+    while (bodyLeft_ > 0 && buff.ReadableBytes() > 0) {
+        size_t n = std::min(std::min(bodyLeft_, buff.ReadableBytes()), BODY_CHUNK);
+        if (!WriteBody_(buff.Peek(), n)) {
+            return bodyError_;
+        }
+        buff.Retrieve(n);
+        bodyLeft_ -= n;
+    }
+    if (bodyLeft_ > 0) {
+        return NO_REQUEST;
+    }
+    if (bodyHandler && !bodyHandler(*this, nullptr, 0)) {
+        return INTERNAL_ERROR;
+    }
+    state_ = FINISH;
+    if (multipart_.Active()) {
+        HTTP_CODE ret = FinishMultipart_();
+        if (ret != GET_REQUEST) {
+            return ret;
         }
+    }
+    LOG_DEBUG("[%s], [%s], [%s], body %zu bytes streamed", method_.c_str(), path_.c_str(), version_.c_str(), bodyLen_);
+    return GET_REQUEST;
+}
 
-        if (lineEnd == buff.BeginWrite()) { // 当前读取完所有数据
-            break;
+// chunked 请求体：取走已到达的部分（第一次调用时先取走头部）边解码边交给 AppendBody_，每次最多解码 BODY_CHUNK 字节的输入。
+// 解码出的数据指向读缓冲区，交出去之后才能取走
+HttpRequest::HTTP_CODE HttpRequest::DecodeBody_(Buffer& buff) {
+    buff.Retrieve(msgLen_);
+    msgLen_ = 0;
+    while (!chunked_.Done() && buff.ReadableBytes() > 0) {
+        const char* data;
+        size_t len;
+        size_t used = chunked_.Decode(buff.Peek(), std::min(buff.ReadableBytes(), BODY_CHUNK), &data, &len);
+        if (chunked_.Failed()) {
+            LOG_WARN("Bad request: %s", ChunkedDecoder::ErrorStr(chunked_.Error()));
+            return BAD_REQUEST;
+        }
+        if (len > 0) {
+            HTTP_CODE ret = AppendBody_(data, len);
+            if (ret != NO_REQUEST) {
+                return ret;
+            }
         }
-        buff.RetrieveUntil(lineEnd + 2); // 移除本行数据 + "\r\n"
+        buff.Retrieve(used);
+    }
+    if (!chunked_.Done()) {
+        return NO_REQUEST;
+    }
+    if (spooling_ && bodyHandler && !bodyHandler(*this, nullptr, 0)) {
+        return INTERNAL_ERROR;
     }
+    state_ = FINISH;
+    HTTP_CODE ret = GET_REQUEST;
+    if (!spooling_) {
+        ret = ParsePost_(); // 解码后的请求体在 body_ 中，表单照常解析
+    } else if (multipart_.Active()) {
+        ret = FinishMultipart_();
+    }
+    if (ret != GET_REQUEST) {
+        return ret;
+    }
+    LOG_DEBUG("[%s], [%s], [%s], chunked body %zu bytes", method_.c_str(), path_.c_str(), version_.c_str(), bodyLen_);
+    return GET_REQUEST;
+}
 
-    LOG_DEBUG("[%s], [%s], [%s]", method_.c_str(), path_.c_str(), version_.c_str());
+// 不超过 bodyMemLimit 时追加到 body_；超过时开始转存，先把 body_ 中已有的部分按 BODY_CHUNK 写出。
+// 返回 NO_REQUEST 表示继续接收，其余为错误
+HttpRequest::HTTP_CODE HttpRequest::AppendBody_(const char* data, size_t len) {
+    bodyLen_ += len;
+    if (bodyLen_ > maxBodySize) {
+        LOG_WARN("Request body too large: > %zu", maxBodySize);
+        return BODY_TOO_LARGE;
+    }
+    if (!spooling_) {
+        if (body_.size() + len <= bodyMemLimit) {
+            body_.append(data, len);
+            return NO_REQUEST;
+        }
+        if (!BeginSpool_()) {
+            return INTERNAL_ERROR;
+        }
+        for (size_t off = 0; off < body_.size(); off += BODY_CHUNK) {
+            if (!WriteBody_(body_.data() + off, std::min(body_.size() - off, BODY_CHUNK))) {
+                return bodyError_;
+            }
+        }
+        body_.clear();
+    }
+    return WriteBody_(data, len) ? NO_REQUEST : bodyError_;
+}
+
+bool HttpRequest::BeginSpool_() {
+    if (!bodyHandler && !multipart_.Active()) {
+        bodyFd_ = CreateTempFile_();
+        if (bodyFd_ < 0) {
+            return false;
+        }
+    }
+    spooling_ = true;
+    return true;
+}
+
+// O_TMPFILE 创建的文件没有名字，关闭后自动删除；文件系统不支持时退回 mkstemp + unlink
+int HttpRequest::CreateTempFile_() {
+    int fd = open(bodyTempDir.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        std::string name = bodyTempDir + "/body.XXXXXX";
+        fd = mkostemp(&name[0], O_CLOEXEC);
+        if (fd >= 0) {
+            unlink(name.c_str());
+        }
+    }
+    if (fd < 0) {
+        LOG_ERROR("Create body temp file in %s failed, errno %d", bodyTempDir.c_str(), errno);
+    }
+    return fd;
+}
+
+bool HttpRequest::WriteFile_(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("Write body temp file failed, errno %d", errno);
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool HttpRequest::WriteBody_(const char* data, size_t len) {
+    if (multipart_.Active()) {
+        return FeedMultipart_(data, len);
+    }
+    if (bodyHandler) {
+        return bodyHandler(*this, data, len);
+    }
+    return WriteFile_(bodyFd_, data, len);
+}
+
+// 请求体格式错误时回复 400；OnPart_ 中止时 bodyError_ 已经设置好
+bool HttpRequest::FeedMultipart_(const char* data, size_t len) {
+    if (multipart_.Feed(data, len)) {
+        return true;
+    }
+    if (multipart_.Error() != MultipartParser::ERR_ABORTED) {
+        LOG_WARN("Bad request: %s", MultipartParser::ErrorStr(multipart_.Error()));
+        bodyError_ = BAD_REQUEST;
+    }
+    return false;
+}
+
+// 字段的名字和值攒在 fieldData_ 中（总长不超过 bodyMemLimit）；文件交给 partHandler，或写进各自的临时文件
+bool HttpRequest::OnPart_(const MultipartParser::Part& part, const char* data, size_t len) {
+    bool start = part.index != partIndex_;
+    partIndex_ = part.index;
+    if (!part.filename.data) {
+        if (!part.name.data) {
+            return true; // 没有名字的字段无法按名字取，丢弃
+        }
+        size_t add = start ? part.name.len + len : len;
+        if (fieldData_.size() + add > bodyMemLimit) {
+            LOG_WARN("Multipart form fields too large: > %zu", bodyMemLimit);
+            bodyError_ = BODY_TOO_LARGE;
+            return false;
+        }
+        if (start) {
+            fields_.push_back(FieldSpan{fieldData_.size(), part.name.len, fieldData_.size() + part.name.len, 0});
+            fieldData_.append(part.name.data, part.name.len);
+        }
+        if (len > 0) {
+            fieldData_.append(data, len);
+            fields_.back().valueLen += len;
+        }
+        return true;
+    }
+    if (partHandler) {
+        return partHandler(*this, part, data, len);
+    }
+    if (start) {
+        if (uploads_.size() >= MAX_UPLOADS) {
+            LOG_WARN("Too many uploaded files: > %zu", MAX_UPLOADS);
+            bodyError_ = BODY_TOO_LARGE;
+            return false;
+        }
+        int fd = CreateTempFile_();
+        if (fd < 0) {
+            return false;
+        }
+        UploadFile file;
+        file.name = part.name.data ? part.name.ToString() : "";
+        file.filename = part.filename.ToString();
+        file.contentType = part.contentType.data ? part.contentType.ToString() : "";
+        file.fd = fd;
+        file.size = 0;
+        uploads_.push_back(std::move(file));
+    }
+    if (!WriteFile_(uploads_.back().fd, data, len)) {
+        return false;
+    }
+    uploads_.back().size += len;
     return true;
 }
 
+HttpRequest::HTTP_CODE HttpRequest::FinishMultipart_() {
+    if (!multipart_.Done()) {
+        LOG_WARN("Bad request: multipart body ends before the close delimiter");
+        return BAD_REQUEST;
+    }
+    for (const FieldSpan& field : fields_) {
+        const char* base = fieldData_.data();
+        post_.push_back(FormField{{base + field.key, field.keyLen}, {base + field.value, field.valueLen}});
+    }
+    return GET_REQUEST;
+}
+
+HttpParser::StrView HttpRequest::GetHeader(const char* name) const {
+    HttpParser::StrView value = parser_.Find(name);
+    return value.data ? value : HttpParser::StrView{"", 0};
+}
+
+HttpParser::StrView HttpRequest::GetHeader(HttpNames::HEADER id) const {
+    HttpParser::StrView value = parser_.Find(id);
+    return value.data ? value : HttpParser::StrView{"", 0};
+}
+
 // 获取 URL 路径，例如 "/index.html"
-std::string HttpRequest::path() const {
+const std::string& HttpRequest::path() const {
     return path_;
 }
 
@@ -103,136 +463,70 @@ std::string HttpRequest::version() const {
     return version_;
 }
 
-// 获取 POST 表单中对应 key 的 value
+// 获取 POST 表单中对应 key 的 value（字段很少，顺序查找；同名字段取第一个）
 std::string HttpRequest::GetPost(const std::string& key) const {
     assert(key != "");
-    if (post_.count(key) == 1) {
-        return post_.find(key)->second;
-    }
-    return "";
+    return GetPost(key.c_str());
 }
 
 std::string HttpRequest::GetPost(const char* key) const {
     assert(key != nullptr);
-    if (post_.count(key) == 1) {
-        return post_.find(key)->second;
+    for (const FormField& field : post_) {
+        if (field.key.Equals(key)) {
+            return field.value.ToString();
+        }
     }
     return "";
 }
 
-// 解析请求行
-bool HttpRequest::ParseRequestLine_(const std::string& line) {
-    std::regex patten("^([^ ]*) ([^ ]*) HTTP/([^ ]*)$"); // 匹配格式：GET /path HTTP/1.1
-    std::smatch subMatch;
-    if (regex_match(line, subMatch, patten)) {
-        method_ = subMatch[1];  // GET / POST
-        path_ = subMatch[2];    // /index.html
-        version_ = subMatch[3]; // 1.1
-        state_ = HEADERS;       // 下一步解析头部
-        return true;
-    }
-    LOG_ERROR("RequestLine Error");
-    return false;
-}
-
-// 解析请求头
-void HttpRequest::ParseHeader_(const std::string& line) {
-    std::regex patten("^([^:]*): ?(.*)$"); // 例如 Host: 127.0.0.1
-    std::smatch subMatch;
-    if (regex_match(line, subMatch, patten)) {
-        header_[subMatch[1]] = subMatch[2]; // 存储键值对
-    } else {
-        state_ = BODY; // 如果这行没冒号，说明是空行 → 请求体开始
+// 解析 POST 请求：表单字段供 GetPost 使用（登录/注册等按路径的处理由路由完成）。
+// 在内存中收齐的 multipart 请求体在这里一次交给解析器
+HttpRequest::HTTP_CODE HttpRequest::ParsePost_() {
+    if (multipart_.Active()) {
+        return FeedMultipart_(body_.data(), body_.size()) ? FinishMultipart_() : bodyError_;
     }
-}
-
-// 解析请求体
-void HttpRequest::ParseBody_(const std::string& line) {
-    body_ = line; // 保存 body 数据
-    ParsePost_(); // 进一步解析 POST 表单
-    state_ = FINISH;
-    LOG_DEBUG("Body:%s, len:%d", line.c_str(), line.size());
-}
-
-// 解析 URL 路径
-void HttpRequest::ParsePath_() {
-    if (path_ == "/") {
-        path_ = "/index.html"; // 首页
-    } else {
-        for (auto& item : DEFAULT_HTML) {
-            if (item == path_) {
-                path_ += ".html"; // 自动加 .html 后缀
-                break;
-            }
-        }
+    if (methodId_ == HttpNames::M_POST && GetHeader(HttpNames::H_CONTENT_TYPE).IEquals("application/x-www-form-urlencoded")) {
+        ParseFromUrlencoded_(); // 解析键值对
     }
+    return GET_REQUEST;
 }
 
-// 解析 POST 请求
-void HttpRequest::ParsePost_() {
-    if (method_ == "POST" && header_["Content-Type"] == "application/x-www-form-urlencoded") {
-        ParseFromUrlencoded_(); // 解析键值对
-
-        // 处理登录/注册请求
-        if (DEFAULT_HTML_TAG.count(path_)) {
-            int tag = DEFAULT_HTML_TAG.find(path_)->second;
-            bool isLogin = (tag == 1);
-            if (UserVerify(post_["username"], post_["password"], isLogin)) {
-                path_ = "/welcome.html"; // 验证成功跳转
-            } else {
-                path_ = "/error.html"; // 失败跳转
-            }
+// 解码 application/x-www-form-urlencoded 的一段（'+' 为空格，%XX 为一个字节），结果放在 arena 中
+HttpParser::StrView HttpRequest::DecodeUrlencoded_(Arena* arena, const char* s, size_t len) {
+    char* out = static_cast<char*>(arena->Alloc(len + 1, 1)); // 解码后不会更长
+    size_t n = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (s[i] == '+') {
+            out[n++] = ' ';
+        } else if (s[i] == '%' && i + 2 < len && isxdigit(static_cast<unsigned char>(s[i + 1])) &&
+                   isxdigit(static_cast<unsigned char>(s[i + 2]))) {
+            out[n++] = static_cast<char>(ConverHex(s[i + 1]) * 16 + ConverHex(s[i + 2]));
+            i += 2;
+        } else {
+            out[n++] = s[i]; // 包括不完整的 %，原样保留
         }
     }
+    out[n] = '\0';
+    return HttpParser::StrView{out, n};
 }
 
-// 解析表单数据格式：key=value&...
+// 解析表单数据格式：key=value&...，字段解码到 arena_ 中（body_ 保持原样）
 void HttpRequest::ParseFromUrlencoded_() {
-    // 如果请求体为空，则无需解析
-    if (body_.size() == 0)
-        return; // 直接返回
-
-    std::string key, value; // 临时用于保存解析出的键和值
-    int num = 0;            // 记录当前字符位置
-    int n = body_.size();   // 请求体总长度
-    int i = 0, j = 0;       // i 和 j 用于记录键值起始位置
-
-    // 遍历请求体中的每个字符
-    for (; i < n; i++) {
-        char ch = body_[i];
-        switch (ch) {
-            // 遇到 '='，说明前面的是 key，开始记录 value
-            case '=':
-                key = body_.substr(j, i - j); // 提取键名
-                j = i + 1;                    // 更新起始位置为下一个字符
-                break;
-            // '+' 在编码中代表空格
-            case '+':
-                body_[i] = ' '; // 替换为真实空格
-                break;
-            // 遇到 URL 编码字符，例如：%20 代表空格
-            case '%':
-                num = ConverHex(body_[i + 1]) * 16 + ConverHex(body_[i + 2]); // 解码计算
-                body_[i + 2] = num % 10 + '0';                                // 低位转换为字符
-                body_[i + 1] = num / 10 + '0';                                // 高位转换为字符
-                i += 2;                                                       // 向后跳过两个字符，因为 %xx 共三个字符
-                break;
-            // '&' 表示一个键值对结束
-            case '&':
-                value = body_.substr(j, i - j); // 获取值
-                j = i + 1;                      // 更新为下一个键值对起始位置
-                post_[key] = value;             // 解析出一组 key=value
-                LOG_DEBUG("%s = %s", key.c_str(), value.c_str());
-                break;
-            default: break;
+    assert(arena_);
+    const char* p = body_.data();
+    const char* end = p + body_.size();
+    while (p < end) {
+        const char* amp = static_cast<const char*>(memchr(p, '&', end - p));
+        const char* stop = amp ? amp : end;
+        const char* eq = static_cast<const char*>(memchr(p, '=', stop - p));
+        if (eq && eq > p) { // 没有 '=' 或键为空的字段忽略
+            FormField field;
+            field.key = DecodeUrlencoded_(arena_, p, eq - p);
+            field.value = DecodeUrlencoded_(arena_, eq + 1, stop - eq - 1);
+            LOG_DEBUG("%s = %s", field.key.data, field.value.data);
+            post_.push_back(field);
         }
-    }
-
-    // 处理最后一个 key=value
-    assert(j <= i);
-    if (post_.count(key) == 0 && j < i) {
-        value = body_.substr(j, i - j);
-        post_[key] = value;
+        p = stop + 1;
     }
 }
 
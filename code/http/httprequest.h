@@ -1,26 +1,31 @@
 #ifndef HTTP_REQUEST_H
 #define HTTP_REQUEST_H
 
-#include <unordered_map> // 用于存储键值对（header、post 数据）
-#include <unordered_set> // 用于快速判断 path 是否需要加 .html
 #include <string>        // 字符串类型
-#include <regex>         // 用于正则表达式解析 HTTP 请求行和头部
+#include <vector>        // 表单字段
+#include <functional>    // 请求体转存回调
 #include <errno.h>       // 错误编号（例如网络异常）
 #include <mysql/mysql.h> // MySQL 数据库操作库
 
 #include "../buffer/buffer.h"    // 自己实现的缓冲区类（用于读取 HTTP 内容）
+#include "../buffer/arena.h"     // 解码后的表单字段
 #include "../log/log.h"          // 日志模块
 #include "../pool/sqlconnpool.h" // MySQL 连接池
+#include "httpparser.h"          // 请求头解析器
+#include "httpchunked.h"         // chunked 请求体解码
+#include "httpmultipart.h"       // multipart/form-data 请求体解析
 
 // HTTP请求解析类
 class HttpRequest {
 public:
-    // 解析状态机的状态
+    // 解析状态机的状态（跨多次读保持，请求不完整时下次从这里继续）
     enum PARSE_STATE {
         REQUEST_LINE, // 解析请求行：例如 "GET /index.html HTTP/1.1"
-        HEADERS,      // 解析请求头
-        BODY,         // 解析请求体（POST内容）
-        FINISH,       // 解析结束
+        HEADERS,      // 解析请求头（请求行、头部内部的进度由 parser_ 记录）
+        BODY,         // 头部已完整，等待 Content-Length 声明的请求体在读缓冲区中到齐
+        BODY_STREAM,  // 请求体超过 bodyMemLimit：边到达边从读缓冲区取走，转存到临时文件或 bodyHandler
+        BODY_CHUNKED, // Transfer-Encoding: chunked：边到达边解码，不超过 bodyMemLimit 时留在内存，超过后转存
+        FINISH,       // 解析结束（下一次 parse 开始新的请求）
     };
 
     // HTTP状态码（返回给HttpConn，用于设置响应内容）
@@ -33,22 +38,69 @@ public:
         FILE_REQUEST,       // 请求静态文件
         INTERNAL_ERROR,     // 服务器内部错误
         CLOSED_CONNECTION,  // 连接已关闭
+        BODY_TOO_LARGE,     // 请求体超过 maxBodySize
+        NOT_IMPLEMENTED,    // 不支持的 Transfer-Encoding
+    };
+
+    // 请求体转存回调：req 的方法、路径和请求头此时已可用；data/len 为按顺序到达的一段请求体（每段不超过 BODY_CHUNK），
+    // 收齐后再以 len == 0 调用一次。返回 false 放弃这个请求（回复 500 并关闭连接）。在工作线程中调用，须线程安全
+    typedef std::function<bool(const HttpRequest& req, const char* data, size_t len)> BodyHandler;
+
+    // 上传文件回调：multipart/form-data 请求体中带 filename 的 part 按顺序分段交给它（part 的视图在这个 part 结束前有效），
+    // 每个 part 结束时以 len == 0 调用一次。返回 false 放弃这个请求（回复 500 并关闭连接）。在工作线程中调用，须线程安全
+    typedef std::function<bool(const HttpRequest& req, const MultipartParser::Part& part, const char* data, size_t len)>
+        PartHandler;
+
+    // 没有 partHandler 时上传的文件：内容在匿名临时文件中（可用 pread 读取，下一次 Init 时关闭）
+    struct UploadFile {
+        std::string name;        // 表单字段名
+        std::string filename;    // 客户端给出的文件名（原样，使用前须检查）
+        std::string contentType; // part 的 Content-Type
+        int fd;                  // 匿名临时文件
+        size_t size;             // 文件大小
     };
 
     // 构造函数：初始化对象
-    HttpRequest() {
+    HttpRequest() : bodyFd_(-1), arena_(nullptr) {
         Init(); // 调用Init函数，设置初始状态
     }
-    ~HttpRequest() = default; // 默认析构函数
+    ~HttpRequest();           // 关闭请求体、上传文件的临时文件
+
+    // 解码表单字段所用的内存池，由 HttpConn 设置（GetPost 的结果在它下一次 Reset 之前有效）
+    void SetArena(Arena* arena) {
+        arena_ = arena;
+    }
 
     // 初始化请求解析状态（可用于复用 HttpRequest 对象）
     void Init();
 
-    // 解析 HTTP 请求（入口函数）
-    bool parse(Buffer& buff);
+    // 解析 HTTP 请求（入口函数）：请求头和 Content-Length 声明的请求体都到齐后才从 buff 中取走，返回 GET_REQUEST；
+    // 还不完整返回 NO_REQUEST（buff 不动，已扫描的进度保留，下次读到更多数据后从停下的地方继续）；格式错误返回 BAD_REQUEST，
+    // 请求体超过 maxBodySize 返回 BODY_TOO_LARGE，请求体转存失败返回 INTERNAL_ERROR，不支持的传输编码返回 NOT_IMPLEMENTED。
+    // 同一个请求的多次调用之间，buff 开头的数据不能被取走或修改（Buffer 整理空间时整体搬移不影响）。
+    // 例外是超过 bodyMemLimit 的请求体和 chunked 请求体：每次调用都把已到达的部分取走（解码、转存），读缓冲区不随请求体增长
+    HTTP_CODE parse(Buffer& buff);
+
+    // 只推进解析、不取走数据：buff 开头是否已有一个完整的请求，返回值同 parse（进度与 parse 共用）
+    HTTP_CODE Check(const Buffer& buff);
+
+    // 是否正在逐段接收请求体（转存或 chunked 解码）：此时读缓冲区中的任何数据都应尽快交给 parse 取走
+    bool BodyStreaming() const {
+        return state_ == BODY_STREAM || state_ == BODY_CHUNKED;
+    }
+
+    // 请求体长度（Content-Length；chunked 时为目前已解码的长度）
+    size_t BodyLength() const {
+        return bodyLen_;
+    }
+
+    // 转存请求体的匿名临时文件（请求完成后可用 pread 读取，下一次 Init 时关闭），请求体在内存中或交给 bodyHandler 时为 -1
+    int BodyFd() const {
+        return bodyFd_;
+    }
 
     // 获取 URL 路径，例如 "/index.html"
-    std::string path() const;
+    const std::string& path() const;
     std::string& path(); // 允许修改 path
 
     // 获取请求方式，例如 "GET" / "POST"
@@ -57,35 +109,92 @@ public:
     // 获取 HTTP 版本号，例如 "1.1"
     std::string version() const;
 
-    // 获取 POST 表单中对应 key 的 value
+    // 获取请求头的值（名字不区分大小写），没有时返回空视图；视图在下一次 Init / parse 之前有效
+    HttpParser::StrView GetHeader(const char* name) const;
+    HttpParser::StrView GetHeader(HttpNames::HEADER id) const; // 常见头部按编号取，省掉名字的哈希
+
+    // 请求方式的编号，不是标准方法时为 M_UNKNOWN
+    HttpNames::METHOD MethodId() const {
+        return methodId_;
+    }
+
+    // multipart/form-data 请求中上传的文件（有 partHandler 时为空）
+    const std::vector<UploadFile>& Uploads() const {
+        return uploads_;
+    }
+
+    // 获取 POST 表单中对应 key 的 value（urlencoded 表单，或 multipart/form-data 中不带 filename 的字段）
     std::string GetPost(const std::string& key) const;
     std::string GetPost(const char* key) const;
 
     // 判断是否为长连接（keep-alive）
     bool IsKeepAlive() const;
 
+    // 校验用户信息（登录/注册表单的路由，见 HttpConn::AddSiteRoutes）
+    static bool UserVerify(const std::string& name, const std::string& pwd, bool isLogin);
+
+    static const size_t BODY_CHUNK = 64 * 1024; // 转存请求体时每次写出/回调的最大长度
+    static const size_t MAX_UPLOADS = 64;       // 一个请求中最多上传的文件数
+
+    // 请求体相关配置（所有连接共享，由 WebServer 按 ServerOptions 设置）
+    static size_t maxBodySize;       // 请求体上限
+    static size_t bodyMemLimit;      // 不超过该值的请求体在读缓冲区中收齐，更大的转存
+    static std::string bodyTempDir;  // 转存临时文件所在目录
+    static BodyHandler bodyHandler;  // 非空时请求体转存给它，而不是临时文件（multipart/form-data 也不解析）
+    static PartHandler partHandler;  // 非空时上传的文件交给它，而不是临时文件
+
 private:
-    // 以下是请求解析的内部函数（分阶段完成解析）
-    bool ParseRequestLine_(const std::string& line); // 解析请求行
-    void ParseHeader_(const std::string& line);      // 解析请求头
-    void ParseBody_(const std::string& line);        // 解析请求体
-    void ParsePath_();                               // 解析 URL 路径
-    void ParsePost_();                               // 解析 POST 请求
+    // 以下是请求解析的内部函数
+    HTTP_CODE Frame_(const Buffer& buff); // 推进请求头解析，确定整个请求（头部 + 请求体）的长度
+    HTTP_CODE StreamBody_(Buffer& buff);  // 取走已到达的请求体并转存
+    HTTP_CODE DecodeBody_(Buffer& buff);  // 取走已到达的 chunked 请求体并解码
+    HTTP_CODE AppendBody_(const char* data, size_t len); // 解码出的一段请求体：放进 body_ 或转存
+    bool BeginSpool_();                   // 开始转存：没有 bodyHandler、不是 multipart 时创建临时文件
+    bool WriteBody_(const char* data, size_t len); // 失败时 bodyError_ 为要回复的状态
+    bool FeedMultipart_(const char* data, size_t len);
+    bool OnPart_(const MultipartParser::Part& part, const char* data, size_t len); // multipart 解析出的一段 part 内容
+    HTTP_CODE FinishMultipart_();                    // 请求体收齐：检查结束标记，字段放进 post_
+    HTTP_CODE ParsePost_();                          // 解析 POST 请求
     void ParseFromUrlencoded_();                     // 解析表单数据格式：key=value&...
+    static int CreateTempFile_();                    // 在 bodyTempDir 中创建匿名临时文件，失败时返回 -1
+    static bool WriteFile_(int fd, const char* data, size_t len);
 
-    // 校验用户信息（用于登录注册）
-    static bool UserVerify(const std::string& name, const std::string& pwd, bool isLogin);
+    // 一个表单字段（已解码，指向 arena_）
+    struct FormField {
+        HttpParser::StrView key;
+        HttpParser::StrView value;
+    };
+
+    // multipart 表单字段在 fieldData_ 中的位置（fieldData_ 增长时会搬移，请求体收齐后才转成 post_ 的视图）
+    struct FieldSpan {
+        size_t key, keyLen;
+        size_t value, valueLen;
+    };
 
     // 成员变量
-    PARSE_STATE state_;                                   // 当前解析状态
-    std::string method_, path_, version_, body_;          // 请求方式、路径、版本、请求体
-    std::unordered_map<std::string, std::string> header_; // 请求头字段
-    std::unordered_map<std::string, std::string> post_;   // POST表单数据
-
-    // 静态常量（所有对象共享）
-    static const std::unordered_set<std::string> DEFAULT_HTML;          // 默认网页
-    static const std::unordered_map<std::string, int> DEFAULT_HTML_TAG; // 网页类型（用于区分登录/注册）
+    PARSE_STATE state_;                                 // 当前解析状态
+    HttpParser parser_;                                 // 请求头解析器（视图指向 head_）
+    std::string head_;                                  // 请求头的拷贝（读缓冲区随后会被回收，容量复用）
+    std::string method_, path_, version_, body_;        // 请求方式、路径、版本、请求体
+    HttpNames::METHOD methodId_;                        // 请求方式的编号
+    bool keepAlive_;                                    // 是否长连接
+    size_t msgLen_;                                     // 整个请求在读缓冲区中的字节数（头部完整后确定；转存时只含头部）
+    size_t bodyLen_;                                    // 请求体长度
+    size_t bodyLeft_;                                   // 转存时还没到达的请求体字节数
+    int bodyFd_;                                        // 转存请求体的临时文件（-1 表示没有）
+    bool spooling_;                                     // 请求体是否在转存（否则在 body_ 中）
+    ChunkedDecoder chunked_;                            // chunked 请求体的解码进度
+    HTTP_CODE bodyError_;                               // WriteBody_ 失败时回复的状态（默认 INTERNAL_ERROR）
+    MultipartParser multipart_;                         // multipart/form-data 请求体的解析进度（其余请求体不使用）
+    int partIndex_;                                     // OnPart_ 正在接收的 part（-1 表示还没有）
+    std::string fieldData_;                             // multipart 表单字段的名字和值（不超过 bodyMemLimit，容量复用）
+    std::vector<FieldSpan> fields_;                     // multipart 表单字段
+    std::vector<UploadFile> uploads_;                   // 上传的文件
+    std::vector<FormField> post_;                       // POST表单数据（按出现顺序，容量复用）
+    Arena* arena_;                                      // 表单字段解码后的存放位置
+
     static int ConverHex(char ch);                                      // 16进制转化为10进制（%20 表示空格' '）
+    static HttpParser::StrView DecodeUrlencoded_(Arena* arena, const char* s, size_t len); // 解码一个表单键或值
 };
 
 #endif // HTTP_REQUEST_H
\ No newline at end of file
@@ -1,22 +1,14 @@
 #include "httpresponse.h"
 
-// 静态映射：文件后缀 → MIME 类型
-const std::unordered_map<std::string, std::string> HttpResponse::SUFFIX_TYPE = {
-    {".html", "text/html"},          {".xml", "text/xml"},          {".xhtml", "application/xhtml+xml"},
-    {".txt", "text/plain"},          {".rtf", "application/rtf"},   {".pdf", "application/pdf"},
-    {".word", "application/nsword"}, {".png", "image/png"},         {".gif", "image/gif"},
-    {".jpg", "image/jpeg"},          {".jpeg", "image/jpeg"},       {".au", "audio/basic"},
-    {".mpeg", "video/mpeg"},         {".mpg", "video/mpeg"},        {".avi", "video/x-msvideo"},
-    {".gz", "application/x-gzip"},   {".tar", "application/x-tar"}, {".css", "text/css "},
-    {".js", "text/javascript "},
-};
-
 // 状态码 → 状态名称（如 200 → OK）
 const std::unordered_map<int, std::string> HttpResponse::CODE_STATUS = {
     {200, "OK"},
     {400, "Bad Request"},
     {403, "Forbidden"},
     {404, "Not Found"},
+    {413, "Payload Too Large"},
+    {500, "Internal Server Error"},
+    {501, "Not Implemented"},
 };
 
 // 错误码 → 错误页面路径（如 404 → "/404.html"）
@@ -26,13 +18,22 @@ const std::unordered_map<int, std::string> HttpResponse::CODE_PATH = {
     {404, "/404.html"},
 };
 
+// 追加字符串字面量（长度在编译期确定，不构造临时 std::string）
+template <size_t N>
+static void AppendLiteral(Buffer& buff, const char (&str)[N]) {
+    buff.Append(str, N - 1);
+}
+
 // 构造函数
 HttpResponse::HttpResponse() {
     code_ = -1;           // -1 代表还未设置状态码
     path_ = srcDir_ = ""; // 资源路径和根目录初始化为空
+    file_ = "";           // 完整文件路径在 MakeResponse 时生成
+    arena_ = nullptr;     // 由 HttpConn 设置
     isKeepAlive_ = false; // 默认关闭长连接
     mmFile_ = nullptr;    // 还未映射文件
     mmFileStat_ = {0};    // stat 结构体清空
+    chunked_ = true;
 }
 
 // 析构函数，释放资源
@@ -41,25 +42,59 @@ HttpResponse::~HttpResponse() {
 }
 
 // 初始化响应对象：传入网站根目录、请求路径、是否为长连接 和 状态码
-void HttpResponse::Init(const std::string& srcDir, std::string& path, bool isKeepAlive, int code) {
-    assert(srcDir != ""); // 根目录不能为空
-    if (mmFile_) {        // 如果上次存在未解除的映射
-        UnmapFile();      // 先解除映射，避免资源泄露
+void HttpResponse::Init(const char* srcDir, const std::string& path, bool isKeepAlive, int code) {
+    assert(srcDir && *srcDir); // 根目录不能为空
+    if (mmFile_) {             // 如果上次存在未解除的映射
+        UnmapFile();           // 先解除映射，避免资源泄露
     }
     code_ = code;               // 设置状态码
     isKeepAlive_ = isKeepAlive; // 设置是否保持连接
-    path_ = path;               // 保存请求路径（例如 "/index.html"）
+    path_ = path;               // 保存请求路径（例如 "/index.html"），复用上次的容量
     srcDir_ = srcDir;           // 保存网站根目录（例如 "./resources"）
+    file_ = "";
     mmFile_ = nullptr;          // 重置映射指针
     mmFileStat_ = {0};          // 重置文件信息
+    source_ = nullptr;          // 上一个响应未生成完的内容不再需要
+}
+
+// 由 source 生成内容的响应
+void HttpResponse::InitGenerated(bool isKeepAlive, int code, const std::string& type, BodySource source) {
+    UnmapFile();
+    code_ = code;
+    isKeepAlive_ = isKeepAlive;
+    path_.clear();
+    type_ = type;
+    mmFileStat_ = {0};
+    source_ = std::move(source);
+    chunked_ = true;
+}
+
+void HttpResponse::DisableChunked() {
+    chunked_ = false;
+    isKeepAlive_ = false;
 }
 
 // 根据当前的 path_、srcDir_ 等生成完整的 HTTP 响应并写入缓冲区 buff
 void HttpResponse::MakeResponse(Buffer& buff) {
+    // 生成内容的响应：只写状态行和响应头，内容由 Generate 分段追加
+    if (source_) {
+        AddStateLine_(buff);
+        AddHeader_(buff);
+        if (chunked_) {
+            AppendLiteral(buff, "Transfer-Encoding: chunked\r\n\r\n");
+        } else {
+            AppendLiteral(buff, "\r\n");
+        }
+        return;
+    }
     /* 判断请求的资源文件 */
     // stat 用来获得文件的属性（大小、权限等）。参数是完整路径字符串。
+    MakeFilePath_();
+    if (code_ >= 400) {
+        // 已经确定是错误（请求格式错误、请求体过大、服务端出错等）：不查找请求的资源，直接返回错误页面
+    }
     // 如果 stat 返回 < 0 表示文件不存在或不可访问，或路径是目录而非文件
-    if (stat((srcDir_ + path_).data(), &mmFileStat_) < 0 || S_ISDIR(mmFileStat_.st_mode)) {
+    else if (stat(file_, &mmFileStat_) < 0 || S_ISDIR(mmFileStat_.st_mode)) {
         code_ = 404; // 文件不存在或是目录 → 404
     }
     // 如果文件的其他用户可读标志未设置，则认为没有公开读取权限
@@ -76,6 +111,23 @@ void HttpResponse::MakeResponse(Buffer& buff) {
     AddContent_(buff);   // 添加响应体相关（将文件映射并写 Content-length）
 }
 
+// 回调可能一次什么也没写（返回 true），继续调用直到写出内容或结束，保证每次都有数据可发
+bool HttpResponse::Generate(Buffer& buff) {
+    if (!source_) {
+        return false;
+    }
+    ChunkedWriter out(buff, chunked_);
+    bool more = true;
+    while (more && out.Written() == 0) {
+        more = source_(out);
+    }
+    if (!more) {
+        out.End();
+        source_ = nullptr;
+    }
+    return more;
+}
+
 // 解除之前的文件映射（如果存在）
 void HttpResponse::UnmapFile() {
     if (mmFile_) {                            // 如果有映射
@@ -95,24 +147,25 @@ size_t HttpResponse::FileLen() const {
 }
 
 // 当需要直接返回错误信息（非静态错误页）时，生成简单的 HTML 错误页面并追加到 buff
-void HttpResponse::ErrorContent(Buffer& buff, std::string message) {
-    std::string body;
-    std::string status;
-    body += "<html><title>Error</title>";         // 构建 HTML 页面标题
-    body += "<body bgcolor=\"ffffff\">";          // 设置背景色
-    if (CODE_STATUS.count(code_) == 1) {          // 若 status 存在于映射表中
-        status = CODE_STATUS.find(code_)->second; // 取出状态描述
-    } else {
-        status = "Bad Request"; // 默认状态描述
-    }
-    body += std::to_string(code_) + " : " + status + "\n"; // 在 body 中添加状态行
-    body += "<p>" + message + "</p>";                      // 添加错误信息
-    body += "<hr><em>TinyWebServer</em></body></html>";    // 结束 HTML
+void HttpResponse::ErrorContent(Buffer& buff, const char* message) {
+    assert(arena_);
+    auto it = CODE_STATUS.find(code_);
+    const char* status = it != CODE_STATUS.end() ? it->second.c_str() : "Bad Request"; // 状态描述，默认 Bad Request
+    // 页面先在 arena_ 中生成，才知道 Content-length
+    size_t len = 0;
+    const char* body = arena_->Format(&len,
+                                      "<html><title>Error</title>"           // 构建 HTML 页面标题
+                                      "<body bgcolor=\"ffffff\">"            // 设置背景色
+                                      "%d : %s\n"                            // 状态行
+                                      "<p>%s</p>"                            // 错误信息
+                                      "<hr><em>TinyWebServer</em></body></html>", // 结束 HTML
+                                      code_, status, message);
 
-    // 先写 Content-length 头，然后写两个 CRLF 表示头部结束
-    buff.Append("Content-length: " + std::to_string(body.size()) + "\r\n\r\n");
-    // 最后把 body 内容写入 buff
-    buff.Append(body);
+    // 先写 Content-length 头，然后写两个 CRLF 表示头部结束，最后把 body 内容写入 buff
+    char header[64];
+    int n = snprintf(header, sizeof(header), "Content-length: %zu\r\n\r\n", len);
+    buff.Append(header, n);
+    buff.Append(body, len);
 }
 
 // 返回 HTTP 状态码
@@ -122,36 +175,43 @@ int HttpResponse::Code() const {
 
 // 添加状态行（HTTP/1.1 200 OK）到缓冲区
 void HttpResponse::AddStateLine_(Buffer& buff) {
-    std::string status; // 用来保存状态短语
-    if (CODE_STATUS.count(code_) == 1) {
-        // 若 code_ 在 CODE_STATUS 表中有映射
-        status = CODE_STATUS.find(code_)->second;
-    } else {
-        // 否则将 code 视为 400（Bad Request）
+    auto it = CODE_STATUS.find(code_); // 状态短语
+    if (it == CODE_STATUS.end()) {
+        // 不在 CODE_STATUS 表中的状态码视为 400（Bad Request）
         code_ = 400;
-        status = CODE_STATUS.find(400)->second;
+        it = CODE_STATUS.find(400);
     }
-    // 拼接并追加状态行，末尾以 CRLF 结束
-    buff.Append("HTTP/1.1 " + std::to_string(code_) + " " + status + "\r\n");
+    // 格式化并追加状态行，末尾以 CRLF 结束
+    char line[64];
+    int n = snprintf(line, sizeof(line), "HTTP/1.1 %d %s\r\n", code_, it->second.c_str());
+    buff.Append(line, n);
 }
 
 // 添加响应头（Connection、Content-type 等）
 void HttpResponse::AddHeader_(Buffer& buff) {
-    buff.Append("Connection: ");                           // 添加 Connection 字段键
-    if (isKeepAlive_) {                                    // 如果是长连接
-        buff.Append("keep-alive\r\n");                     // 指明 keep-alive
-        buff.Append("keep-alive: max=6, timeout=120\r\n"); // 自定义 keep-alive 属性（非标准写法也可）
+    AppendLiteral(buff, "Connection: ");                           // 添加 Connection 字段键
+    if (isKeepAlive_) {                                            // 如果是长连接
+        AppendLiteral(buff, "keep-alive\r\n");                     // 指明 keep-alive
+        AppendLiteral(buff, "keep-alive: max=6, timeout=120\r\n"); // 自定义 keep-alive 属性（非标准写法也可）
     } else {
-        buff.Append("close\r\n"); // 否则连接关闭
+        AppendLiteral(buff, "close\r\n"); // 否则连接关闭
     }
-    // 添加 Content-type 头，调用 GetFileType_() 推断 MIME 类型
-    buff.Append("Content-type: " + GetFileType_() + "\r\n");
+    // 添加 Content-type 头：生成的内容用指定的类型，文件调用 GetFileType_() 按后缀推断 MIME 类型
+    const char* type = source_ ? type_.c_str() : GetFileType_();
+    AppendLiteral(buff, "Content-type: ");
+    buff.Append(type, strlen(type));
+    AppendLiteral(buff, "\r\n");
 }
 
 // 添加响应体相关信息并把真实文件映射到内存（mmap）
 void HttpResponse::AddContent_(Buffer& buff) {
+    // 没有对应错误页面的错误码（413、500），生成简单的错误页面
+    if (code_ >= 400 && CODE_PATH.count(code_) == 0) {
+        ErrorContent(buff, CODE_STATUS.find(code_)->second.c_str());
+        return;
+    }
     // 以只读方式打开目标文件
-    int srcFd = open((srcDir_ + path_).data(), O_RDONLY);
+    int srcFd = open(file_, O_RDONLY);
     if (srcFd < 0) {                          // 打开失败（文件不存在或权限不足等）
         ErrorContent(buff, "File NotFound!"); // 构造简单的错误内容
         return;                               // 返回，不继续后续映射逻辑
@@ -159,7 +219,7 @@ void HttpResponse::AddContent_(Buffer& buff) {
 
     /* 将文件映射到内存提高文件的访问速度
        MAP_PRIVATE 建立一个写入时拷贝的私有映射 */
-    LOG_DEBUG("file path %s", (srcDir_ + path_).data()); // 日志输出当前处理的文件路径
+    LOG_DEBUG("file path %s", file_); // 日志输出当前处理的文件路径
 
     // // mmap 会返回映射的起始地址（void*），这里将其转换为 int* 再检查结果
     // int* mmRet = (int*)mmap(0, mmFileStat_.st_size, PROT_READ, MAP_PRIVATE, srcFd, 0);
@@ -180,7 +240,9 @@ void HttpResponse::AddContent_(Buffer& buff) {
 
     close(srcFd); // 关闭文件描述符（映射后可关闭 fd）
     // 添加 Content-length 头并在头部后添加额外的 CRLF 分隔头与 body
-    buff.Append("Content-length: " + std::to_string(mmFileStat_.st_size) + "\r\n\r\n");
+    char header[64];
+    int n = snprintf(header, sizeof(header), "Content-length: %lld\r\n\r\n", static_cast<long long>(mmFileStat_.st_size));
+    buff.Append(header, n);
 }
 
 // 如果 code_ 对应有错误页面映射（CODE_PATH 中存在），替换 path_ 为错误页路径并更新 mmFileStat_
@@ -189,20 +251,23 @@ void HttpResponse::ErrorHtml_() {
         // 找到对应的错误页面路径，例如 "/404.html"
         path_ = CODE_PATH.find(code_)->second;
         // 更新 mmFileStat_ 为错误页的 stat 信息
-        stat((srcDir_ + path_).data(), &mmFileStat_);
+        MakeFilePath_();
+        stat(file_, &mmFileStat_);
     }
 }
 
-// 根据 path_ 的后缀返回对应的 MIME 类型（例如 ".html" -> "text/html"）
-std::string HttpResponse::GetFileType_() {
+void HttpResponse::MakeFilePath_() {
+    assert(arena_);
+    file_ = arena_->Concat(srcDir_.data(), srcDir_.size(), path_.data(), path_.size());
+}
+
+// 根据 path_ 的后缀返回对应的 MIME 类型（例如 ".html" -> "text/html"），后缀表见 HttpNames::MimeType
+const char* HttpResponse::GetFileType_() {
     /* 判断文件类型 */
     std::string::size_type idx = path_.find_last_of('.'); // 找到最后一个 '.' 的位置
     if (idx == std::string::npos) {                       // 如果没找到扩展名
         return "text/plain";                              // 默认返回 text/plain
     }
-    std::string suffix = path_.substr(idx); // 取出后缀，例如 ".html"
-    if (SUFFIX_TYPE.count(suffix) == 1) {
-        return SUFFIX_TYPE.find(suffix)->second; // 如果映射表中有该后缀，返回对应 MIME
-    }
-    return "text/plain"; // 否则返回 text/plain 作为兜底
+    const char* type = HttpNames::MimeType(path_.data() + idx, path_.size() - idx); // 后缀原地查表，不拷贝
+    return type ? type : "text/plain"; // 表中没有的后缀返回 text/plain 作为兜底
 }
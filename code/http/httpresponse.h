@@ -1,27 +1,59 @@
 #ifndef HTTP_RESPONSE_H
 #define HTTP_RESPONSE_H
 
-#include <unordered_map> // 用于定义静态映射，快速查找 MIME 类型、状态码等
+#include <unordered_map> // 用于定义静态映射，快速查找状态码等
 #include <string>        // to_string()
+#include <functional>    // 生成内容的回调
 #include <fcntl.h>       // open() 文件读写方式
 #include <unistd.h>      // close() 文件
 #include <sys/stat.h>    // stat() 获取文件属性（大小、类型等）
 #include <sys/mman.h>    // mmap(), munmap() 用于将文件映射到内存，提高读取效率
 
 #include "../buffer/buffer.h"
+#include "../buffer/arena.h" // 生成响应时的临时字符串
 #include "../log/log.h"
+#include "httpchunked.h" // 分块写出生成的内容
+#include "httpnames.h"   // 文件后缀 → MIME 类型
 
 class HttpResponse {
 public:
+    // 生成响应内容的回调：每次调用往 out 写一段内容，还有后续内容时返回 true，写完返回 false（之后不再调用）。
+    // 在写出响应的线程中调用（上一段写完才生成下一段），捕获的状态随这个响应释放
+    typedef std::function<bool(ChunkedWriter& out)> BodySource;
+
     HttpResponse();  // 构造函数
     ~HttpResponse(); // 析构函数，释放资源
 
     // 初始化响应对象：传入网站根目录、请求路径、是否为长连接 和 状态码
-    void Init(const std::string& srcDir, std::string& path, bool isKeepAlive = false, int code = -1);
+    void Init(const char* srcDir, const std::string& path, bool isKeepAlive = false, int code = -1);
+
+    // 生成响应时临时字符串（完整文件路径、错误页面）所用的内存池，由 HttpConn 设置，每批响应生成前回收
+    void SetArena(Arena* arena) {
+        arena_ = arena;
+    }
+
+    // 由 source 生成内容的响应（不对应文件），内容类型为 type。
+    // 响应头带 Transfer-Encoding: chunked，内容边生成边写出，不需要事先知道长度
+    void InitGenerated(bool isKeepAlive, int code, const std::string& type, BodySource source);
+
+    // 对方不认识 chunked（HTTP/1.0）：生成的内容原样写出，以关闭连接表示结束
+    void DisableChunked();
 
-    // 根据当前的 path_、srcDir_ 等生成完整的 HTTP 响应并写入缓冲区 buff
+    // 根据当前的 path_、srcDir_ 等生成完整的 HTTP 响应并写入缓冲区 buff（生成内容的响应只写响应头）
     void MakeResponse(Buffer& buff);
 
+    // 生成内容的响应：把下一段内容（至少一个字节，或结束标记）追加到 buff；返回 false 表示已全部生成
+    bool Generate(Buffer& buff);
+
+    // 是否为生成内容的响应（且还没生成完）
+    bool IsGenerated() const {
+        return static_cast<bool>(source_);
+    }
+
+    bool IsKeepAlive() const {
+        return isKeepAlive_;
+    }
+
     // 解除之前的文件映射（如果存在）
     void UnmapFile();
 
@@ -32,7 +64,7 @@ public:
     size_t FileLen() const;
 
     // 当需要直接返回错误信息（非静态错误页）时，生成简单的 HTML 错误页面并追加到 buff
-    void ErrorContent(Buffer& buff, std::string message);
+    void ErrorContent(Buffer& buff, const char* message);
 
     // 返回 HTTP 状态码
     int Code() const;
@@ -43,19 +75,24 @@ private:
     void AddContent_(Buffer& buff);   // 添加响应体（文件内容）
 
     void ErrorHtml_();          // 设置错误页面路径
-    std::string GetFileType_(); // 根据文件后缀推断 MIME 类型
+    void MakeFilePath_();       // 在 arena_ 中拼出 srcDir_ + path_
+    const char* GetFileType_(); // 根据文件后缀推断 MIME 类型
 
     int code_;         // HTTP 状态码（如 200、404）
     bool isKeepAlive_; // 是否启用 HTTP 长连接
 
     std::string path_;   // 请求资源路径（如 "/index.html"）
     std::string srcDir_; // 网站根目录（如 "/var/www/html/"）
+    const char* file_;   // 完整文件路径（srcDir_ + path_，在 arena_ 中）
+    Arena* arena_;       // 临时字符串的内存池
+
+    BodySource source_;       // 生成内容的回调（为空表示普通的文件响应）
+    std::string type_;        // 生成内容的 MIME 类型
+    bool chunked_;            // 生成的内容是否按 chunked 编码写出
 
     char* mmFile_;           // mmap 映射的文件指针
     struct stat mmFileStat_; // 记录目标文件的信息（大小、类型等）
 
-    // 静态映射：文件后缀 → MIME 类型
-    static const std::unordered_map<std::string, std::string> SUFFIX_TYPE;
     // 状态码 → 状态名称（如 200 → OK）
     static const std::unordered_map<int, std::string> CODE_STATUS;
     // 错误码 → 错误页面路径（如 404 → "/404.html"）
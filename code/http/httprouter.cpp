@@ -0,0 +1,195 @@
+#include "httprouter.h"
+#include <string.h> // memchr / memcmp
+
+#include "httprequest.h"
+
+const int HttpRouter::MAX_PARAMS;
+
+HttpParser::StrView HttpRouter::Params::Get(const char* name) const {
+    for (int i = 0; i < count; i++) {
+        if (items[i].name.Equals(name)) {
+            return items[i].value;
+        }
+    }
+    return HttpParser::StrView{nullptr, 0};
+}
+
+HttpRouter::Node::Node() : param(-1), catchAll(-1) {
+    for (int& h : handlers) {
+        h = -1;
+    }
+}
+
+HttpRouter::HttpRouter() {
+    nodes_.emplace_back(); // 根
+}
+
+int HttpRouter::NewNode_() {
+    nodes_.emplace_back();
+    return static_cast<int>(nodes_.size()) - 1;
+}
+
+// nodes_ 可能扩容，全程只用下标访问节点
+int HttpRouter::InsertStatic_(int node, const char* s, size_t len) {
+    while (len > 0) {
+        size_t pos = nodes_[node].indices.find(s[0]);
+        if (pos == std::string::npos) {
+            int child = NewNode_();
+            nodes_[child].prefix.assign(s, len);
+            nodes_[node].indices.push_back(s[0]);
+            nodes_[node].children.push_back(child);
+            return child;
+        }
+        int child = nodes_[node].children[pos];
+        const std::string& prefix = nodes_[child].prefix;
+        size_t common = 0;
+        while (common < prefix.size() && common < len && prefix[common] == s[common]) {
+            common++;
+        }
+        if (common < prefix.size()) {
+            // 只有前 common 个字符相同：在中间插入一个节点，原节点成为它的子节点（首字符不变，indices 不用改）
+            int mid = NewNode_();
+            nodes_[mid].prefix = nodes_[child].prefix.substr(0, common);
+            nodes_[child].prefix.erase(0, common);
+            nodes_[mid].indices.push_back(nodes_[child].prefix[0]);
+            nodes_[mid].children.push_back(child);
+            nodes_[node].children[pos] = mid;
+            child = mid;
+        }
+        node = child;
+        s += common;
+        len -= common;
+    }
+    return node;
+}
+
+bool HttpRouter::Add(HttpNames::METHOD method, const std::string& pattern, Handler handler) {
+    if (pattern.empty() || pattern[0] != '/' || !handler) {
+        return false;
+    }
+    // 先检查整个模式，格式错误时不改动路由表
+    int params = 0;
+    for (size_t i = 0; i < pattern.size(); i++) {
+        if (pattern[i] != ':' && pattern[i] != '*') {
+            continue;
+        }
+        size_t end = pattern.find('/', i);
+        if (pattern[i - 1] != '/' || (pattern[i] == ':' && (end == i + 1 || pattern.size() == i + 1)) ||
+            (pattern[i] == '*' && end != std::string::npos) || ++params > MAX_PARAMS) {
+            return false; // 参数不是完整的一段、参数名为空、前缀不在末尾、参数太多
+        }
+        if (pattern.find_first_of(":*", i + 1) < end) {
+            return false;
+        }
+    }
+
+    int node = 0;
+    size_t i = 0;
+    while (i < pattern.size()) {
+        size_t next = pattern.find_first_of(":*", i);
+        if (next == std::string::npos) {
+            next = pattern.size();
+        }
+        node = InsertStatic_(node, pattern.data() + i, next - i);
+        if (next == pattern.size()) {
+            break;
+        }
+        size_t end = pattern[next] == ':' ? pattern.find('/', next) : pattern.size();
+        if (end == std::string::npos) {
+            end = pattern.size();
+        }
+        std::string name = pattern.substr(next + 1, end - next - 1);
+        int& slot = pattern[next] == ':' ? nodes_[node].param : nodes_[node].catchAll;
+        if (slot < 0) {
+            int child = NewNode_(); // nodes_ 可能扩容，slot 失效，重新取
+            (pattern[next] == ':' ? nodes_[node].param : nodes_[node].catchAll) = child;
+            nodes_[child].name = name;
+            node = child;
+        } else if (nodes_[slot].name != name) {
+            return false; // 同一位置已有名字不同的参数（之前的静态部分已插入，不影响查找）
+        } else {
+            node = slot;
+        }
+        i = end;
+    }
+
+    int& h = nodes_[node].handlers[method];
+    if (h < 0) {
+        h = static_cast<int>(handlers_.size());
+        handlers_.push_back(std::move(handler));
+    } else {
+        handlers_[h] = std::move(handler);
+    }
+    return true;
+}
+
+int HttpRouter::Handler_(const Node& node, HttpNames::METHOD method) const {
+    int h = method < HttpNames::M_UNKNOWN ? node.handlers[method] : -1;
+    return h >= 0 ? h : node.handlers[HttpNames::M_UNKNOWN];
+}
+
+// node 的 prefix 已经匹配，从 p 开始匹配子树；返回处理函数的下标，-1 表示没有匹配（params 恢复原样）
+int HttpRouter::Match_(int node, HttpNames::METHOD method, const char* p, const char* end, Params* params) const {
+    const Node& n = nodes_[node];
+    if (p == end) {
+        int h = Handler_(n, method);
+        if (h >= 0) {
+            return h;
+        }
+    } else {
+        const char* idx = static_cast<const char*>(memchr(n.indices.data(), *p, n.indices.size()));
+        if (idx) {
+            int child = n.children[idx - n.indices.data()];
+            const std::string& prefix = nodes_[child].prefix;
+            if (static_cast<size_t>(end - p) >= prefix.size() && memcmp(p, prefix.data(), prefix.size()) == 0) {
+                int h = Match_(child, method, p + prefix.size(), end, params);
+                if (h >= 0) {
+                    return h;
+                }
+            }
+        }
+        if (n.param >= 0 && *p != '/') {
+            const char* segEnd = static_cast<const char*>(memchr(p, '/', end - p));
+            if (!segEnd) {
+                segEnd = end;
+            }
+            Params::Param& param = params->items[params->count++];
+            param.name = HttpParser::StrView{nodes_[n.param].name.data(), nodes_[n.param].name.size()};
+            param.value = HttpParser::StrView{p, static_cast<size_t>(segEnd - p)};
+            int h = Match_(n.param, method, segEnd, end, params);
+            if (h >= 0) {
+                return h;
+            }
+            params->count--;
+        }
+    }
+    // 前缀匹配剩下的全部（可以为空）
+    if (n.catchAll >= 0) {
+        int h = Handler_(nodes_[n.catchAll], method);
+        if (h >= 0) {
+            Params::Param& param = params->items[params->count++];
+            param.name = HttpParser::StrView{nodes_[n.catchAll].name.data(), nodes_[n.catchAll].name.size()};
+            param.value = HttpParser::StrView{p, static_cast<size_t>(end - p)};
+            return h;
+        }
+    }
+    return -1;
+}
+
+const HttpRouter::Handler* HttpRouter::Find(HttpNames::METHOD method, const char* path, size_t len,
+                                            Params* params) const {
+    params->count = 0;
+    const char* query = static_cast<const char*>(memchr(path, '?', len));
+    int h = Match_(0, method, path, query ? query : path + len, params);
+    return h >= 0 ? &handlers_[h] : nullptr;
+}
+
+bool HttpRouter::Dispatch(const HttpRequest& req, HttpResponse& resp) const {
+    if (handlers_.empty()) {
+        return false;
+    }
+    const std::string& path = req.path();
+    Params params;
+    const Handler* handler = Find(req.MethodId(), path.data(), path.size(), &params);
+    return handler && (*handler)(req, params, resp);
+}
@@ -0,0 +1,90 @@
+#ifndef HTTP_ROUTER_H
+#define HTTP_ROUTER_H
+
+#include <string>     // 模式中的静态部分、参数名
+#include <vector>     // 节点、处理函数
+#include <functional> // 处理函数
+
+#include "httpnames.h"  // 方法编号
+#include "httpparser.h" // StrView
+
+class HttpRequest;
+class HttpResponse;
+
+// 路由表：启动时注册，之后只读（多线程同时查找是安全的）。
+// 路径模式（以 '/' 开头）：
+//   /login.html     精确匹配
+//   /user/:id       参数：匹配一个非空的路径段（到下一个 '/' 为止），处理函数中按名字取值
+//   /static/*path   前缀：匹配剩下的全部（可以为空），只能在末尾；名字可以省略（"/static/*"）
+// 各模式按静态部分的公共前缀合并成一棵压缩前缀树（radix tree），查找沿请求路径走一遍，代价与路径长度成正比，
+// 与注册了多少路由无关。同一位置静态部分优先，其次参数，最后前缀；某个分支走到底没有匹配时回到上一个分叉换下一种。
+// 只匹配路径部分（'?' 之前），参数值是请求路径中的原始字节（不做百分号解码）
+class HttpRouter {
+public:
+    static const int MAX_PARAMS = 8; // 一个模式中最多的参数个数
+
+    // 匹配到的参数：名字指向路由表，值指向请求路径，在请求处理期间有效
+    struct Params {
+        struct Param {
+            HttpParser::StrView name;
+            HttpParser::StrView value;
+        };
+        Param items[MAX_PARAMS];
+        int count;
+
+        // 按名字取值，没有时返回空视图（data 为 nullptr）
+        HttpParser::StrView Get(const char* name) const;
+    };
+
+    // 处理函数：返回 true 表示已经设置好 resp（Init 一个文件或 InitGenerated 生成的内容），
+    // false 时交给 HttpConn::requestHandler、再按路径返回静态文件。在处理请求的线程中调用，须线程安全
+    typedef std::function<bool(const HttpRequest& req, const Params& params, HttpResponse& resp)> Handler;
+
+    HttpRouter();
+
+    // 注册 method 的处理函数，method 为 HttpNames::M_UNKNOWN 表示任意方法（该路径没有注册请求的方法时使用）。
+    // 同一方法和模式重复注册时替换原来的处理函数。模式格式错误、同一位置的参数名不一致时返回 false
+    bool Add(HttpNames::METHOD method, const std::string& pattern, Handler handler);
+    bool Get(const std::string& pattern, Handler handler) {
+        return Add(HttpNames::M_GET, pattern, std::move(handler));
+    }
+    bool Post(const std::string& pattern, Handler handler) {
+        return Add(HttpNames::M_POST, pattern, std::move(handler));
+    }
+    bool Any(const std::string& pattern, Handler handler) {
+        return Add(HttpNames::M_UNKNOWN, pattern, std::move(handler));
+    }
+
+    // 查找 path（到 '?' 为止）上 method 的处理函数，没有时返回 nullptr；params 写入匹配到的参数
+    const Handler* Find(HttpNames::METHOD method, const char* path, size_t len, Params* params) const;
+
+    // 按请求的方法和路径查找并调用处理函数；没有匹配的路由或处理函数返回 false 时返回 false
+    bool Dispatch(const HttpRequest& req, HttpResponse& resp) const;
+
+    bool Empty() const {
+        return handlers_.empty();
+    }
+
+private:
+    struct Node {
+        std::string prefix;         // 这条边上的静态字符（参数、前缀节点为空）
+        std::string indices;        // 各静态子节点 prefix 的首字符，与 children 一一对应
+        std::vector<int> children;  // 静态子节点
+        int param;                  // ":name" 子节点（-1 表示没有）
+        int catchAll;               // "*name" 子节点
+        std::string name;           // 参数、前缀节点的名字
+        int handlers[HttpNames::M_UNKNOWN + 1]; // 各方法的处理函数在 handlers_ 中的下标，最后一项为任意方法
+
+        Node();
+    };
+
+    int NewNode_();
+    int InsertStatic_(int node, const char* s, size_t len); // 沿静态字符下行，必要时分裂边，返回终点
+    int Handler_(const Node& node, HttpNames::METHOD method) const; // 节点上 method 的处理函数，-1 表示没有
+    int Match_(int node, HttpNames::METHOD method, const char* p, const char* end, Params* params) const;
+
+    std::vector<Node> nodes_; // nodes_[0] 为根（prefix 为空）
+    std::vector<Handler> handlers_;
+};
+
+#endif // HTTP_ROUTER_H
@@ -0,0 +1,222 @@
+#include "httpscan.h"
+#include <string.h> // strchr
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HTTP_SCAN_X86 1
+#include <immintrin.h> // SSE4.2 / AVX2 intrinsics（按函数启用 target，不需要全局编译选项）
+#endif
+
+// 字符分类表和 Token 的半字节查找表，静态初始化时从 tchar 的定义生成
+struct ScanTables {
+    unsigned char cls[256];
+    // Token 半字节查表：字节 b 是 tchar 当且仅当 lo[b & 0xF] & hi[b >> 4] != 0。
+    // lo[l] 的第 h 位表示 (h << 4 | l) 是 tchar；hi[h] = 1 << h（h >= 8 时为 0，tchar 都小于 0x80）。
+    // 两张表各重复一次凑成 32 字节，AVX2 的 vpshufb 在两个 128 位通道内各查一次
+    unsigned char tokenLo[32];
+    unsigned char tokenHi[32];
+
+    ScanTables() {
+        memset(tokenLo, 0, sizeof(tokenLo));
+        memset(tokenHi, 0, sizeof(tokenHi));
+        for (int c = 0; c < 256; c++) {
+            unsigned char v = 0;
+            if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                (c != 0 && strchr("!#$%&'*+-.^_`|~", c))) {
+                v |= HttpScan::TOKEN;
+                tokenLo[c & 0xF] |= 1 << (c >> 4);
+            }
+            if ((c >= 0x21 && c <= 0x7E) || c >= 0x80) {
+                v |= HttpScan::TARGET | HttpScan::VALUE;
+            }
+            if (c == ' ' || c == '\t') {
+                v |= HttpScan::VALUE;
+            }
+            cls[c] = v;
+        }
+        for (int h = 0; h < 8; h++) {
+            tokenHi[h] = 1 << h;
+        }
+        memcpy(tokenLo + 16, tokenLo, 16);
+        memcpy(tokenHi + 16, tokenHi, 16);
+    }
+};
+
+static const ScanTables TABLES;
+
+const unsigned char* const HttpScan::CLASS = TABLES.cls;
+
+// ---------------------------------------------------------------- SCALAR
+
+template <int K>
+static size_t ScanScalar(const char* p, const char* end) {
+    const char* start = p;
+    while (p < end && (TABLES.cls[static_cast<unsigned char>(*p)] & K)) {
+        p++;
+    }
+    return p - start;
+}
+
+#ifdef HTTP_SCAN_X86
+
+// ---------------------------------------------------------------- SSE4.2
+
+// pcmpestri 区间模式：RANGES 中每两个字节是一个 [lo, hi] 区间，返回块内第一个落在任一区间里的字节下标，没有则返回 16
+#define HTTP_SCAN_RANGES (_SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT)
+
+// SSE4.2 版本同时作为 AVX2 版本不足 32 字节的尾部处理：强制内联进 AVX2 函数后按 VEX 编码生成，
+// 避免 ymm 高半部分未清零时执行传统 SSE 指令的状态切换开销（单独调用时开销可达数十个周期）
+#define HTTP_SCAN_SSE42 __attribute__((target("sse4.2"), always_inline)) inline
+
+HTTP_SCAN_SSE42 static size_t TargetSse42(const char* p, const char* end) {
+    static const char RANGES[16] = "\x00\x20\x7f\x7f"; // 控制字符、空格、DEL
+    const __m128i ranges = _mm_loadu_si128(reinterpret_cast<const __m128i*>(RANGES));
+    const char* start = p;
+    for (; end - p >= 16; p += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int i = _mm_cmpestri(ranges, 4, v, 16, HTTP_SCAN_RANGES);
+        if (i != 16) {
+            return p - start + i;
+        }
+    }
+    return p - start + ScanScalar<HttpScan::TARGET>(p, end);
+}
+
+HTTP_SCAN_SSE42 static size_t ValueSse42(const char* p, const char* end) {
+    static const char RANGES[16] = "\x00\x08\x0a\x1f\x7f\x7f"; // 除 HTAB 以外的控制字符（含 CR、LF）、DEL
+    const __m128i ranges = _mm_loadu_si128(reinterpret_cast<const __m128i*>(RANGES));
+    const char* start = p;
+    for (; end - p >= 16; p += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int i = _mm_cmpestri(ranges, 6, v, 16, HTTP_SCAN_RANGES);
+        if (i != 16) {
+            return p - start + i;
+        }
+    }
+    return p - start + ScanScalar<HttpScan::VALUE>(p, end);
+}
+
+// tchar 有 9 个不连续区间，超过 pcmpestri 的 8 个，改用半字节查表精确判断
+HTTP_SCAN_SSE42 static size_t TokenSse42(const char* p, const char* end) {
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(TABLES.tokenLo));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(TABLES.tokenHi));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+    const char* start = p;
+    for (; end - p >= 16; p += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i l = _mm_shuffle_epi8(lo, _mm_and_si128(v, nibble));
+        __m128i h = _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(l, h), zero));
+        if (mask) {
+            return p - start + __builtin_ctz(mask);
+        }
+    }
+    return p - start + ScanScalar<HttpScan::TOKEN>(p, end);
+}
+
+// ---------------------------------------------------------------- AVX2
+
+__attribute__((target("avx2"))) static size_t TargetAvx2(const char* p, const char* end) {
+    const __m256i space = _mm256_set1_epi8(0x20);
+    const __m256i del = _mm256_set1_epi8(0x7F);
+    const char* start = p;
+    for (; end - p >= 32; p += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        // 无符号 v <= 0x20 等价于 min(v, 0x20) == v（0x80 以上的字节不会被当成负数）
+        __m256i stop = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(v, space), v), _mm256_cmpeq_epi8(v, del));
+        unsigned mask = _mm256_movemask_epi8(stop);
+        if (mask) {
+            return p - start + __builtin_ctz(mask);
+        }
+    }
+    return p - start + TargetSse42(p, end);
+}
+
+__attribute__((target("avx2"))) static size_t ValueAvx2(const char* p, const char* end) {
+    const __m256i ctrl = _mm256_set1_epi8(0x1F);
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i del = _mm256_set1_epi8(0x7F);
+    const char* start = p;
+    for (; end - p >= 32; p += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i isCtrl = _mm256_cmpeq_epi8(_mm256_min_epu8(v, ctrl), v);
+        __m256i stop = _mm256_or_si256(_mm256_andnot_si256(_mm256_cmpeq_epi8(v, tab), isCtrl),
+                                       _mm256_cmpeq_epi8(v, del));
+        unsigned mask = _mm256_movemask_epi8(stop);
+        if (mask) {
+            return p - start + __builtin_ctz(mask);
+        }
+    }
+    return p - start + ValueSse42(p, end);
+}
+
+__attribute__((target("avx2"))) static size_t TokenAvx2(const char* p, const char* end) {
+    const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(TABLES.tokenLo));
+    const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(TABLES.tokenHi));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+    const char* start = p;
+    for (; end - p >= 32; p += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i l = _mm256_shuffle_epi8(lo, _mm256_and_si256(v, nibble));
+        __m256i h = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+        unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(l, h), zero));
+        if (mask) {
+            return p - start + __builtin_ctz(mask);
+        }
+    }
+    return p - start + TokenSse42(p, end);
+}
+
+#endif // HTTP_SCAN_X86
+
+bool HttpScan::Supported(LEVEL level) {
+#ifdef HTTP_SCAN_X86
+    __builtin_cpu_init(); // 可能在其他静态初始化中被调用，先确保 CPUID 信息已就绪
+    switch (level) {
+        case SCALAR: return true;
+        case SSE42: return __builtin_cpu_supports("sse4.2");
+        case AVX2: return __builtin_cpu_supports("avx2");
+    }
+    return false;
+#else
+    return level == SCALAR;
+#endif
+}
+
+HttpScan::Impl HttpScan::Select_(LEVEL level) {
+    if (level > AVX2) {
+        level = AVX2;
+    }
+    while (!Supported(level)) {
+        level = static_cast<LEVEL>(level - 1);
+    }
+    Impl impl = {SCALAR, ScanScalar<TOKEN>, ScanScalar<TARGET>, ScanScalar<VALUE>};
+#ifdef HTTP_SCAN_X86
+    if (level == SSE42) {
+        impl = {SSE42, TokenSse42, TargetSse42, ValueSse42};
+    } else if (level == AVX2) {
+        impl = {AVX2, TokenAvx2, TargetAvx2, ValueAvx2};
+    }
+#endif
+    return impl;
+}
+
+HttpScan::Impl HttpScan::impl_ = HttpScan::Select_(HttpScan::AVX2);
+
+bool HttpScan::SetLevel(LEVEL level) {
+    if (!Supported(level)) {
+        return false;
+    }
+    impl_ = Select_(level);
+    return true;
+}
+
+const char* HttpScan::LevelName(LEVEL level) {
+    switch (level) {
+        case SCALAR: return "scalar";
+        case SSE42: return "sse4.2";
+        case AVX2: return "avx2";
+    }
+    return "unknown";
+}
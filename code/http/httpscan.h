@@ -0,0 +1,66 @@
+#ifndef HTTP_SCAN_H
+#define HTTP_SCAN_H
+
+#include <stddef.h> // size_t
+
+// 请求头字段的向量化扫描：从 p 开始数出连续多少个字节属于某个字符类，停下的位置就是分隔符或非法字符。
+//   Token  — 方法、头部名（RFC 9110 tchar）；在合法输入中停在空格或冒号上
+//   Target — 请求目标（可见 ASCII 及 0x80 以上）；停在空格上
+//   Value  — 头部值（可见 ASCII、空格、HTAB 及 0x80 以上）；停在 CR / LF 上
+// 在哪里停下由调用方判断是分隔符还是非法字符，所以找分隔符和校验字符是同一遍扫描。
+// 三档实现，进程启动时按 CPUID 选最高的一档：
+//   AVX2   — 每次 32 字节。Value/Target 用无符号比较找控制字符；Token 用半字节查表（vpshufb）精确判断字符集合
+//   SSE4.2 — 每次 16 字节。Value/Target 用 pcmpestri 的区间匹配找停止字符；Token 同样用半字节查表（pshufb）
+//   SCALAR — 逐字节查 256 项字符分类表（非 x86 平台只有这一档）
+// 向量实现只在剩余字节足够一整块时使用，不会读到 end 之后；不足一块的尾部逐字节处理。
+class HttpScan {
+public:
+    enum LEVEL {
+        SCALAR = 0,
+        SSE42,
+        AVX2,
+    };
+
+    // 字符类（每个字节查表即可判断），解析器在逐字节判断时也使用
+    enum CHAR_CLASS {
+        TOKEN = 1,
+        TARGET = 2,
+        VALUE = 4,
+    };
+
+    static size_t Token(const char* p, const char* end) {
+        return impl_.token(p, end);
+    }
+    static size_t Target(const char* p, const char* end) {
+        return impl_.target(p, end);
+    }
+    static size_t Value(const char* p, const char* end) {
+        return impl_.value(p, end);
+    }
+    static bool Is(char c, CHAR_CLASS k) {
+        return CLASS[static_cast<unsigned char>(c)] & k;
+    }
+
+    static LEVEL Level() {
+        return impl_.level;
+    }
+    static const char* LevelName(LEVEL level);
+    static bool Supported(LEVEL level); // CPU 是否支持该档
+    static bool SetLevel(LEVEL level);  // 切换实现（测试、基准用），CPU 不支持时返回 false；不是线程安全的
+
+private:
+    typedef size_t (*ScanFunc)(const char* p, const char* end);
+    struct Impl {
+        LEVEL level;
+        ScanFunc token;
+        ScanFunc target;
+        ScanFunc value;
+    };
+
+    static Impl Select_(LEVEL level);
+
+    static const unsigned char* const CLASS; // 256 项字符分类表
+    static Impl impl_;
+};
+
+#endif // HTTP_SCAN_H
@@ -48,6 +48,14 @@ void Log::SetLevel(int level) {
     level_ = level;
 }
 
+// 绑定异步写线程的 CPU
+bool Log::PinWriteThread(int cpu) {
+    if (!writeThread_) {
+        return false;
+    }
+    return CpuAffinity::Pin(writeThread_->native_handle(), cpu);
+}
+
 // 判断日志系统是否已经初始化
 bool Log::IsOpen() {
     return isOpen_;
@@ -1,16 +1,17 @@
 #ifndef LOG_H
 #define LOG_H
 
-#include <mutex>              // 用于 std::mutex 锁，保证线程安全
-#include <string>             // 字符串支持
-#include <thread>             // std::thread 用于异步写日志线程
-#include <sys/time.h>         // 用于获取精确时间（秒+微秒）
-#include <string.h>           // C 风格字符串处理函数
-#include <stdarg.h>           // 可变参数（例如 printf 形式）
-#include <assert.h>           // 断言，用于检查程序错误
-#include <sys/stat.h>         // mkdir 创建目录
-#include "blockqueue.h"       // 阻塞队列用于异步写日志
-#include "../buffer/buffer.h" // 自定义 Buffer 类，用来临时构建日志内容
+#include <mutex>                 // 用于 std::mutex 锁，保证线程安全
+#include <string>                // 字符串支持
+#include <thread>                // std::thread 用于异步写日志线程
+#include <sys/time.h>            // 用于获取精确时间（秒+微秒）
+#include <string.h>              // C 风格字符串处理函数
+#include <stdarg.h>              // 可变参数（例如 printf 形式）
+#include <assert.h>              // 断言，用于检查程序错误
+#include <sys/stat.h>            // mkdir 创建目录
+#include "blockqueue.h"          // 阻塞队列用于异步写日志
+#include "../buffer/buffer.h"    // 自定义 Buffer 类，用来临时构建日志内容
+#include "../pool/cpuaffinity.h" // 写线程绑核
 
 class Log {
 public:
@@ -22,9 +23,10 @@ public:
     void write(int level, const char* format, ...); // 写日志（支持同步/异步）
     void flush();                                   // 冲刷缓冲区（将内容立刻写入文件）
 
-    int GetLevel();           // 获取日志等级
-    void SetLevel(int level); // 设置日志等级
-    bool IsOpen();            // 判断日志系统是否已经初始化
+    int GetLevel();               // 获取日志等级
+    void SetLevel(int level);     // 设置日志等级
+    bool IsOpen();                // 判断日志系统是否已经初始化
+    bool PinWriteThread(int cpu); // 把异步写线程绑定到 cpu（同步日志时返回 false）
 
 private:
     Log();                                // 构造函数（设为 private，防止外部构造，单例模式）
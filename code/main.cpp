@@ -1,12 +1,48 @@
 #include <unistd.h>
 #include "server/webserver.h"
+#include "server/prefork.h"
 
 int main() {
     /* 守护进程 后台运行 */
     // daemon(1, 0);
 
-    WebServer server(1316, 3, 60000, false,          /* 端口 ET模式 timeoutMs 优雅退出  */
-                     3306, "root", "123456", "mydb", /* Mysql配置 */
-                     12, 6, true, 1, 1024);          /* 连接池数量 线程池数量 日志开关 日志等级 日志异步队列容量 */
-    server.Start();
-}
\ No newline at end of file
+    ServerOptions opts;
+    // opts.reactorNum = 4;        /* 多 Reactor：每核一个事件循环（0 为单 Reactor + 线程池） */
+    // opts.sharedListen = false;  /* 多 Reactor 监听方式：SO_REUSEPORT(false) / 共享 + EPOLLEXCLUSIVE(true) */
+    // opts.mainSubReactor = false; /* 主从 Reactor：主线程 accept 后经 eventfd 分给 reactorNum 个从 Reactor */
+    // opts.leastLoaded = false;    /* 主从 Reactor 分配策略：轮询(false) / 连接数最少(true) */
+    // opts.ioUring = false;        /* I/O 后端：io_uring(true，不支持时回退 epoll) / epoll(false) */
+    // opts.dispatch = DISPATCH_POOL; /* 线程池分发：共享队列 / 按 fd 连接亲和(AFFINITY) / 循环读写+工作线程计算(PROACTOR) */
+    // opts.inlineThreshold = 16384; /* 自适应内联：轻量 GET 的响应不超过该字节数时在事件循环线程内处理（0 关闭） */
+    // opts.reactorCpus = "0-3";   /* 事件循环绑核（cpulist 格式），连接槽就近分配到对应 NUMA 节点 */
+    // opts.workerCpus = "4-9";    /* 工作线程绑核 */
+    // opts.logCpu = 10;           /* 异步日志写线程绑核（-1 不绑定） */
+    // opts.busyPollUs = 50;       /* 忙轮询：阻塞前先自旋的微秒数，并设置 SO_BUSY_POLL（0 关闭） */
+    // opts.queueHighWater = 256;  /* 过载保护：线程池排队任务数高水位（0 关闭），配合 queueLowWater 恢复 */
+    // opts.queueDelayHighUs = 20000; /* 过载保护：队首任务排队时间上限（微秒，0 不判断） */
+    // opts.shedMode = SHED_503;    /* 过载时新连接：回 503(SHED_503) / 暂停 accept(SHED_PAUSE) */
+    // opts.maxConnPerIp = 64;      /* 单个客户端 IP 的并发连接数上限，超出回 429（0 不限） */
+    // opts.ipRate = 100;           /* 单个 IP 的令牌桶速率（请求/秒，0 不限），ipBurst 为桶容量 */
+    // opts.listenBacklog = 1024;   /* listen backlog（上限 net.core.somaxconn），过小时突发连接会被丢弃重传 */
+    // opts.deferAcceptSec = 5;     /* TCP_DEFER_ACCEPT：客户端发来数据才唤醒 accept（0 关闭） */
+    // opts.fastOpenQueue = 256;    /* TCP_FASTOPEN 队列长度（0 关闭，需 net.ipv4.tcp_fastopen & 2） */
+    // opts.tcpNoDelay = true;      /* 新连接设置 TCP_NODELAY */
+    // opts.tcpCork = true;         /* 多段的 writev（带文件内容或流水线的多个响应）用 TCP_CORK 包住 */
+    // opts.unixPath = "/run/tinyweb.sock"; /* 额外监听 Unix 域 socket（本机反向代理用），unixOnly 为 true 时不监听 TCP */
+    // opts.pipelineDepth = 16;     /* HTTP/1.1 流水线：每批最多处理的请求数，响应合并成一次 writev（1 即逐个处理） */
+    // opts.maxBodySize = 64 << 20; /* 请求体上限（超过回复 413）；超过 bodyMemLimit 的请求体边到达边转存到 bodyTempDir 下的临时文件 */
+    // opts.partHandler = ...;     /* multipart/form-data 上传的文件分段交给该回调（默认写进临时文件，见 HttpRequest::Uploads） */
+    // opts.routes = [](HttpRouter& r) { r.Get("/api/user/:id", ...); }; /* 注册动态接口的路由（参数、前缀匹配，按方法分派），见 http/readme.md */
+    // opts.requestHandler = ...;  /* 请求处理回调：可用 HttpResponse::InitGenerated 返回分块（chunked）写出的动态内容，见 http/readme.md */
+    // opts.handoffPath = "/run/tinyweb.handoff"; /* 零停机重启：新进程经此控制 socket 继承监听 socket，旧进程随后排空退出 */
+    // opts.drainTimeoutMs = 10000; /* 排空期限：进行中的请求最多等待的毫秒数（也可在 SIGTERM 处理函数中调用 server.Drain()） */
+    // opts.workerProcesses = 4; /* 多进程：master 看护 4 个工作进程（各自完整的 WebServer），连接池数量为各进程合计 */
+
+    /* workerProcesses 为 0 时直接在本进程运行；否则每个工作进程 fork 之后再创建自己的 WebServer */
+    return Prefork::Run(opts, [](const ServerOptions& o) {
+        return std::unique_ptr<WebServer>(new WebServer(1316, 3, 60000, false,          /* 端口 ET模式 timeoutMs 优雅退出  */
+                                                         3306, "root", "123456", "mydb", /* Mysql配置 */
+                                                         12, 6, true, 1, 1024,           /* 连接池数量 线程池数量 日志开关 日志等级 日志异步队列容量 */
+                                                         o));                            /* 扩展配置 */
+    });
+}
@@ -0,0 +1,91 @@
+#include "cpuaffinity.h"
+#include <sched.h>           // cpu_set_t, CPU_SET
+#include <dirent.h>          // opendir / readdir，查找 nodeM 目录项
+#include <stdio.h>           // snprintf, sscanf
+#include <stdlib.h>          // strtol
+#include <unistd.h>          // syscall
+#include <sys/syscall.h>     // __NR_mbind
+#include <linux/mempolicy.h> // MPOL_PREFERRED
+
+bool CpuAffinity::Parse(const std::string& list, std::vector<int>* cpus) {
+    cpus->clear();
+    const char* p = list.c_str();
+    while (*p) {
+        char* end;
+        long first = strtol(p, &end, 10);
+        if (end == p || first < 0 || first >= CPU_SETSIZE) {
+            return false;
+        }
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            if (end == p + 1 || last < first || last >= CPU_SETSIZE) {
+                return false;
+            }
+            p = end;
+        }
+        for (long cpu = first; cpu <= last; cpu++) {
+            cpus->push_back(static_cast<int>(cpu));
+        }
+        if (*p == ',') {
+            p++;
+        } else if (*p) {
+            return false;
+        }
+    }
+    return !cpus->empty();
+}
+
+bool CpuAffinity::Pin(pthread_t thread, int cpu) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+}
+
+bool CpuAffinity::PinSelf(int cpu) {
+    return Pin(pthread_self(), cpu);
+}
+
+int CpuAffinity::NodeOf(int cpu) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    DIR* dir = opendir(path);
+    if (!dir) {
+        return -1;
+    }
+    int node = -1;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (sscanf(entry->d_name, "node%d", &node) == 1) {
+            break;
+        }
+        node = -1;
+    }
+    closedir(dir);
+    return node;
+}
+
+bool CpuAffinity::PreferNode(void* addr, size_t len, int node) {
+    const int MASK_BITS = sizeof(unsigned long) * 8;
+    if (node < 0 || node >= MASK_BITS) {
+        return false;
+    }
+    unsigned long mask = 1UL << node;
+    return syscall(__NR_mbind, addr, len, MPOL_PREFERRED, &mask, MASK_BITS, 0) == 0;
+}
+
+std::string CpuAffinity::ToString(const std::vector<int>& cpus) {
+    std::string str;
+    for (size_t i = 0; i < cpus.size(); i++) {
+        if (i) {
+            str += ',';
+        }
+        str += std::to_string(cpus[i]);
+    }
+    return str;
+}
@@ -0,0 +1,27 @@
+#ifndef CPU_AFFINITY_H
+#define CPU_AFFINITY_H
+
+#include <pthread.h> // pthread_t, pthread_setaffinity_np
+#include <string>    // CPU 列表字符串
+#include <vector>    // 解析后的 CPU 编号
+
+// 线程绑核与 NUMA 就近分配的工具函数（只依赖 glibc 和内核接口，不依赖 libnuma）
+class CpuAffinity {
+public:
+    // 解析 Linux cpulist 格式（与 taskset -c 相同），如 "0-3,8,10-11" -> {0,1,2,3,8,10,11}；格式错误返回 false
+    static bool Parse(const std::string& list, std::vector<int>* cpus);
+
+    static bool Pin(pthread_t thread, int cpu); // 把线程绑定到单个 CPU
+    static bool PinSelf(int cpu);               // 把当前线程绑定到单个 CPU
+
+    // CPU 所在的 NUMA 节点（读 /sys/devices/system/cpu/cpuN/nodeM），无法确定时返回 -1
+    static int NodeOf(int cpu);
+
+    // 让 [addr, addr + len) 的物理页优先从 node 分配（mbind MPOL_PREFERRED，只影响之后首次访问的页）
+    // addr 须按页对齐；内核不支持或 node < 0 时返回 false，此时仍按默认的首次访问就近分配
+    static bool PreferNode(void* addr, size_t len, int node);
+
+    static std::string ToString(const std::vector<int>& cpus); // 日志输出用，如 "0,1,2"
+};
+
+#endif // CPU_AFFINITY_H
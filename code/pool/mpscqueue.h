@@ -0,0 +1,51 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic> // 无锁链表头
+
+// 侵入式节点：由调用方提供存储（例如每个连接一个），队列本身不分配内存
+struct MpscNode {
+    MpscNode* next;
+};
+
+// 无锁多生产者单消费者队列：生产者用 CAS 把节点压到链表头，消费者一次 exchange 取走整条链表再反转成 FIFO 顺序。
+// 消费者总是整体取走，不会在链表中间摘节点，因此不存在 ABA 问题。
+// 同一个节点在被消费者取走之前不能再次 Push。
+class MpscQueue {
+public:
+    MpscQueue() : head_(nullptr) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // 生产者：压入一个节点。返回压入前队列是否为空——只有由空变非空时才需要唤醒消费者
+    bool Push(MpscNode* node) {
+        MpscNode* old = head_.load(std::memory_order_relaxed);
+        do {
+            node->next = old;
+        } while (!head_.compare_exchange_weak(old, node, std::memory_order_release, std::memory_order_relaxed));
+        return old == nullptr;
+    }
+
+    // 消费者：取走全部节点，按压入顺序串成链表返回（空队列返回 nullptr）
+    MpscNode* PopAll() {
+        MpscNode* node = head_.exchange(nullptr, std::memory_order_acquire);
+        MpscNode* list = nullptr;
+        while (node) {
+            MpscNode* next = node->next;
+            node->next = list;
+            list = node;
+            node = next;
+        }
+        return list;
+    }
+
+    bool Empty() const {
+        return head_.load(std::memory_order_relaxed) == nullptr;
+    }
+
+private:
+    std::atomic<MpscNode*> head_; // 最后压入的节点
+};
+
+#endif // MPSC_QUEUE_H
@@ -6,7 +6,11 @@
 #include <condition_variable>
 #include <functional>
 #include <thread>
+#include <vector>
+#include <memory>
+#include <chrono>
 #include <assert.h>
+#include "cpuaffinity.h"
 
 class ThreadPool {
 public:
@@ -15,41 +19,56 @@ public:
 
     // 尽量用make_shared代替new，如果通过new再传递给shared_ptr，内存是不连续的，会造成内存碎片化
     // make_shared:传递右值，功能是在动态内存中分配一个对象并初始化它，返回指向此对象的shared_ptr
-    explicit ThreadPool(size_t threadCount = 8) : pool_(std::make_shared<Pool>()) {
+    // cpus 非空时第 i 个线程绑定到 cpus[i % cpus.size()]
+    explicit ThreadPool(size_t threadCount = 8, const std::vector<int>& cpus = std::vector<int>())
+        : pool_(std::make_shared<Pool>()) {
         assert(threadCount > 0); // 确保线程数为正
         for (size_t i = 0; i < threadCount; ++i) {
-            // 创建线程并立即 detach（不保留 thread 对象）
-            std::thread([this]() {
+            int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+            // 线程只持有共享状态 pool（不捕获 this），ThreadPool 对象被移动后线程仍然有效
+            std::shared_ptr<Pool> pool = pool_;
+            threads_.emplace_back([pool, cpu]() {
+                if (cpu >= 0) {
+                    CpuAffinity::PinSelf(cpu); // 先绑核，之后线程自己分配的内存按首次访问落在本地 NUMA 节点
+                }
                 // 每个线程在这里运行一个循环：取任务->执行->等待
-                std::unique_lock<std::mutex> locker(pool_->mtx_);
+                std::unique_lock<std::mutex> locker(pool->mtx_);
                 while (true) {
-                    if (!pool_->tasks.empty()) {                     // 如果有任务
-                        auto task = std::move(pool_->tasks.front()); // 取出任务（使用移动）
-                        pool_->tasks.pop();                          // 弹出队首
+                    if (!pool->tasks.empty()) {                    // 如果有任务
+                        auto task = std::move(pool->tasks.front()); // 取出任务（使用移动）
+                        pool->tasks.pop();                          // 弹出队首
                         locker.unlock(); // 解锁允许其它线程访问队列（因为已经把任务取出来了，所以可以提前解锁了）
-                        task();          // 执行任务
+                        task.fn();       // 执行任务
                         locker.lock();   // 执行完成后重新加锁继续循环
                     }
-                    // 如果池已关闭，则退出线程循环
-                    else if (pool_->isClosed) {
+                    // 队列已空且池已关闭，退出线程循环（关闭前入队的任务都会执行完）
+                    else if (pool->isClosed) {
                         break;
                     }
                     // 没任务且未关闭则等待条件变量唤醒
                     else {
-                        pool_->cond_.wait(locker); // 等待,如果任务来了就notify
+                        pool->cond_.wait(locker); // 等待,如果任务来了就notify
                     }
                 }
-            }).detach(); // 将线程分离，线程退出自己清理资源
+            });
         }
     }
 
-    // 析构：标记关闭并通知所有工作线程
+    // 析构：标记关闭、通知所有工作线程，并等待它们执行完队列中剩余的任务后退出（join）
+    // 析构返回后不会再有任务在运行，调用方可以放心释放任务引用的对象
     ~ThreadPool() {
         if (pool_) {
-            std::unique_lock<std::mutex> locker(pool_->mtx_);
-            pool_->isClosed = true; // 设置关闭标志
+            {
+                std::unique_lock<std::mutex> locker(pool_->mtx_);
+                pool_->isClosed = true; // 设置关闭标志
+            }
+            pool_->cond_.notify_all(); // 唤醒所有等待线程以便它们退出
+        }
+        for (auto& thread : threads_) {
+            if (thread.joinable()) {
+                thread.join();
+            }
         }
-        pool_->cond_.notify_all(); // 唤醒所有等待线程以便它们退出
     }
 
     // 向线程池添加任务（泛型：可以传入可调用对象）
@@ -57,20 +76,37 @@ public:
     void AddTask(T&& task) {
         {
             std::unique_lock<std::mutex> locker(pool_->mtx_); // 加锁保护队列
-            pool_->tasks.emplace(std::forward<T>(task));      // 将任务放入队列（完美转发）
+            pool_->tasks.push({std::function<void()>(std::forward<T>(task)), Clock::now()}); // 入队并记录入队时间
         }
         pool_->cond_.notify_one(); // 通知一个等待中的线程有新任务
     }
 
+    // 当前排队（尚未被工作线程取走）的任务数，以及队首任务已等待的时间（微秒，队列为空时为 0），用于过载判断
+    void Load(size_t* depth, int64_t* oldestWaitUs) {
+        std::lock_guard<std::mutex> locker(pool_->mtx_);
+        *depth = pool_->tasks.size();
+        *oldestWaitUs = pool_->tasks.empty() ? 0
+                                             : std::chrono::duration_cast<std::chrono::microseconds>(
+                                                   Clock::now() - pool_->tasks.front().enqueued).count();
+    }
+
 private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Task {
+        std::function<void()> fn;   // 无参返回 void 的可调用对象
+        Clock::time_point enqueued; // 入队时间（排队延迟 = 被取走时间 - 入队时间）
+    };
+
     // 用一个结构体封装起来，方便调用
     struct Pool {
         std::mutex mtx_;                         // 保护 tasks、isClosed 的互斥锁
         std::condition_variable cond_;           // 任务到来或关闭时通知线程
         bool isClosed = false;                   // 标记线程池是否关闭（注意：需要初始化）
-        std::queue<std::function<void()>> tasks; // 任务队列，元素为无参返回 void 的可调用对象
+        std::queue<Task> tasks;                  // 任务队列
     };
-    std::shared_ptr<Pool> pool_; // 使用 shared_ptr 使得线程持有共享状态对象
+    std::shared_ptr<Pool> pool_;       // 使用 shared_ptr 使得线程持有共享状态对象
+    std::vector<std::thread> threads_; // 工作线程（析构时 join）
 };
 
 #endif // THREADPOOL_H
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "clientlimiter.h"
+#include <chrono> // steady_clock
+
+ClientLimiter::ClientLimiter(int maxConn, double rate, double burst)
+    : maxConn_(maxConn), rate_(rate), burst_(burst > 0 ? burst : (rate > 1 ? rate : 1)) {}
+
+int64_t ClientLimiter::NowNs_() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// IPv4 地址的低位往往相近（同一网段），乘以黄金分割常数后取高位作为分片号
+ClientLimiter::Shard& ClientLimiter::ShardOf_(uint32_t ip) {
+    return shards_[(ip * 2654435761u) >> 26];
+}
+
+ClientLimiter::Entry& ClientLimiter::Find_(Shard& shard, uint32_t ip, int64_t now) {
+    auto it = shard.table.find(ip);
+    if (it == shard.table.end()) {
+        it = shard.table.emplace(ip, Entry{0, burst_, now}).first;
+    } else if (rate_ > 0) {
+        Entry& e = it->second;
+        e.tokens += (now - e.lastNs) * 1e-9 * rate_;
+        if (e.tokens > burst_) {
+            e.tokens = burst_;
+        }
+        e.lastNs = now;
+    }
+    return it->second;
+}
+
+void ClientLimiter::Sweep_(Shard& shard, int64_t now) {
+    if (now - shard.lastSweepNs < SWEEP_NS) {
+        return;
+    }
+    shard.lastSweepNs = now;
+    for (auto it = shard.table.begin(); it != shard.table.end();) {
+        const Entry& e = it->second;
+        bool full = rate_ <= 0 || e.tokens + (now - e.lastNs) * 1e-9 * rate_ >= burst_;
+        if (e.conns == 0 && full) {
+            it = shard.table.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+ClientLimiter::RESULT ClientLimiter::Connect(uint32_t ip) {
+    Shard& shard = ShardOf_(ip);
+    int64_t now = NowNs_();
+    std::lock_guard<std::mutex> locker(shard.mtx);
+    Sweep_(shard, now);
+    Entry& e = Find_(shard, ip, now);
+    if (maxConn_ > 0 && e.conns >= maxConn_) {
+        return DENY_CONN;
+    }
+    if (rate_ > 0 && e.tokens < 1) {
+        return DENY_RATE;
+    }
+    e.conns++;
+    return ALLOW;
+}
+
+void ClientLimiter::Disconnect(uint32_t ip) {
+    Shard& shard = ShardOf_(ip);
+    std::lock_guard<std::mutex> locker(shard.mtx);
+    auto it = shard.table.find(ip);
+    if (it != shard.table.end() && it->second.conns > 0) {
+        it->second.conns--;
+    }
+}
+
+bool ClientLimiter::Acquire(uint32_t ip) {
+    if (rate_ <= 0) {
+        return true;
+    }
+    Shard& shard = ShardOf_(ip);
+    int64_t now = NowNs_();
+    std::lock_guard<std::mutex> locker(shard.mtx);
+    Entry& e = Find_(shard, ip, now);
+    if (e.tokens < 1) {
+        return false;
+    }
+    e.tokens -= 1;
+    return true;
+}
+
+size_t ClientLimiter::Size() {
+    size_t n = 0;
+    for (int i = 0; i < SHARD_NUM; i++) {
+        std::lock_guard<std::mutex> locker(shards_[i].mtx);
+        n += shards_[i].table.size();
+    }
+    return n;
+}
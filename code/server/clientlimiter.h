@@ -0,0 +1,63 @@
+#ifndef CLIENT_LIMITER_H
+#define CLIENT_LIMITER_H
+
+#include <unordered_map> // 分片内的 IP -> 状态表
+#include <mutex>         // 分片锁
+#include <stdint.h>      // uint32_t / int64_t
+#include <stddef.h>      // size_t
+
+// 按客户端 IP 的限流：
+//   - 并发连接数上限：Connect 成功后计数 +1，连接关闭时 Disconnect -1；
+//   - 令牌桶：每个 IP 的桶以 rate 个/秒补充、最多 burst 个，每个请求取走一个。
+// 状态按 IP 哈希分到 SHARD_NUM 个分片，每个分片一把锁，不同 IP 的连接在不同线程上基本不会互相等待。
+// 没有连接、桶已经补满的 IP 与新出现的 IP 无法区分，定期从表中清除（时间驱动的淘汰），表的大小只与活跃 IP 数有关。
+class ClientLimiter {
+public:
+    // Connect 的结果
+    enum RESULT {
+        ALLOW = 0,  // 接纳
+        DENY_CONN,  // 该 IP 的并发连接数已达上限
+        DENY_RATE,  // 该 IP 的令牌已用完
+    };
+
+    // maxConn <= 0 不限连接数；rate <= 0 不限速率；burst <= 0 时取 rate（至少 1）
+    ClientLimiter(int maxConn, double rate, double burst);
+
+    bool Enabled() const {
+        return maxConn_ > 0 || rate_ > 0;
+    }
+
+    RESULT Connect(uint32_t ip); // 新连接：检查连接数上限和令牌（令牌为 0 的 IP 连新连接也不接纳，但不消耗令牌）
+    void Disconnect(uint32_t ip); // Connect 成功的连接关闭时调用
+    bool Acquire(uint32_t ip);    // 一个新请求：取走一个令牌，没有则返回 false
+
+    size_t Size(); // 当前跟踪的 IP 数
+
+private:
+    struct Entry {
+        int conns;       // 当前并发连接数
+        double tokens;   // 桶中剩余令牌
+        int64_t lastNs;  // 上次补充令牌的时间
+    };
+
+    struct Shard {
+        std::mutex mtx;
+        std::unordered_map<uint32_t, Entry> table;
+        int64_t lastSweepNs = 0; // 上次清理时间
+    };
+
+    static const int SHARD_NUM = 64;          // 分片数（2 的幂）
+    static const int64_t SWEEP_NS = 1000000000; // 每个分片最多每秒清理一次
+
+    static int64_t NowNs_();
+    Shard& ShardOf_(uint32_t ip);
+    Entry& Find_(Shard& shard, uint32_t ip, int64_t now); // 取出（不存在则插入满桶）并补充令牌
+    void Sweep_(Shard& shard, int64_t now);               // 删除空闲且桶已满的 IP
+
+    int maxConn_;
+    double rate_;
+    double burst_;
+    Shard shards_[SHARD_NUM];
+};
+
+#endif // CLIENT_LIMITER_H
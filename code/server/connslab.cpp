@@ -0,0 +1,48 @@
+#include "connslab.h"
+#include <sys/mman.h> // mmap / munmap
+#include <new>        // placement new, std::bad_alloc
+#include "../pool/cpuaffinity.h" // mbind 到指定 NUMA 节点
+
+ConnSlab::ConnSlab(size_t capacity) : slots_(nullptr), capacity_(capacity), bytes_(capacity * sizeof(Slot)) {
+    // MAP_NORESERVE：只预留地址空间，没用到的 fd 不占物理内存；匿名映射保证初始全零（gen = 0，未构造）
+    void* mem = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mem == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    slots_ = static_cast<Slot*>(mem);
+}
+
+ConnSlab::~ConnSlab() {
+    for (size_t i = 0; i < capacity_; i++) {
+        if (slots_[i].constructed) {
+            reinterpret_cast<HttpConn*>(&slots_[i].conn)->~HttpConn(); // 析构时仍在线的连接会被关闭
+        }
+    }
+    munmap(slots_, bytes_);
+}
+
+bool ConnSlab::PreferNode(int node) {
+    return CpuAffinity::PreferNode(slots_, bytes_, node);
+}
+
+uint64_t ConnSlab::Open(int fd) {
+    assert(fd >= 0 && static_cast<size_t>(fd) < capacity_);
+    Slot& slot = slots_[fd];
+    if (!slot.constructed) {
+        new (&slot.conn) HttpConn();
+        slot.constructed = true;
+    }
+    uint32_t gen = slot.gen.load(std::memory_order_relaxed);
+    gen += (gen & 1) ? 2 : 1; // 上一个连接未 Release（异常路径）时也保证 id 变化且为奇数
+    slot.gen.store(gen, std::memory_order_release);
+    return static_cast<uint64_t>(gen) << 32 | static_cast<uint32_t>(fd);
+}
+
+void ConnSlab::Release(int fd) {
+    assert(fd >= 0 && static_cast<size_t>(fd) < capacity_);
+    Slot& slot = slots_[fd];
+    uint32_t gen = slot.gen.load(std::memory_order_relaxed);
+    if (gen & 1) {
+        slot.gen.store(gen + 1, std::memory_order_release);
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef CONN_SLAB_H
+#define CONN_SLAB_H
+
+#include <atomic>             // 槽位代数（generation）跨线程可见
+#include <type_traits>        // std::aligned_storage
+#include <stdint.h>           // uint32_t / uint64_t
+#include <stddef.h>           // size_t
+#include <assert.h>           // 断言
+#include "../http/httpconn.h" // HTTP 连接类
+
+// 按 fd 下标的连接槽数组，取代 unordered_map<int, HttpConn>：
+//   - 一次性 mmap 预留 capacity 个按缓存行对齐的槽位，物理页在首次使用时才分配，HttpConn 也在首次使用时才构造；
+//   - 查找就是数组下标，无哈希、无扩容，HttpConn* 在整个生命周期内地址不变；
+//   - 每个槽位有一个代数：Open 时变为奇数（在线），Release 时变为偶数（空闲），
+//     连接 id = 代数 << 32 | fd 存入 epoll_event.data.u64 和定时器回调，fd 被复用后旧 id 查不到连接。
+class ConnSlab {
+public:
+    explicit ConnSlab(size_t capacity);
+    ~ConnSlab();
+
+    ConnSlab(const ConnSlab&) = delete;
+    ConnSlab& operator=(const ConnSlab&) = delete;
+
+    uint64_t Open(int fd); // 启用 fd 对应的槽位（按需构造 HttpConn），返回新的连接 id
+    void Release(int fd);  // 连接已关闭，使该 fd 的旧 id 全部失效
+
+    HttpConn* At(int fd) {
+        assert(fd >= 0 && static_cast<size_t>(fd) < capacity_ && slots_[fd].constructed);
+        return reinterpret_cast<HttpConn*>(&slots_[fd].conn);
+    }
+
+    // 按 id 查找连接；id 已过期（连接关闭或 fd 已被新连接复用）返回 nullptr
+    HttpConn* Get(uint64_t id) {
+        size_t fd = static_cast<uint32_t>(id);
+        if (fd >= capacity_ || slots_[fd].gen.load(std::memory_order_acquire) != static_cast<uint32_t>(id >> 32)) {
+            return nullptr;
+        }
+        return reinterpret_cast<HttpConn*>(&slots_[fd].conn);
+    }
+
+    // fd 上是否有在线连接（已 Open、尚未 Release）
+    bool Online(int fd) const {
+        assert(fd >= 0 && static_cast<size_t>(fd) < capacity_);
+        return slots_[fd].gen.load(std::memory_order_acquire) & 1;
+    }
+
+    // 当前 fd 上连接的 id（用于重新注册 epoll 事件）
+    uint64_t Id(int fd) const {
+        assert(fd >= 0 && static_cast<size_t>(fd) < capacity_);
+        return static_cast<uint64_t>(slots_[fd].gen.load(std::memory_order_acquire)) << 32 | static_cast<uint32_t>(fd);
+    }
+
+    // 让槽位数组的物理页优先从 NUMA 节点 node 分配（须在槽位首次使用前、由绑核后的循环线程调用）
+    bool PreferNode(int node);
+
+    size_t Capacity() const {
+        return capacity_;
+    }
+
+private:
+    // 一个槽位独占整数个缓存行，相邻 fd 的连接被不同线程处理时不会伪共享
+    struct alignas(64) Slot {
+        typename std::aligned_storage<sizeof(HttpConn), alignof(HttpConn)>::type conn; // HttpConn 的存储（按需构造）
+        std::atomic<uint32_t> gen; // 代数：奇数在线，偶数空闲；初始为 0
+        bool constructed;          // conn 是否已构造
+    };
+
+    Slot* slots_;     // mmap 得到的槽位数组（初始全零）
+    size_t capacity_; // 槽位数（fd 上限）
+    size_t bytes_;    // 映射大小
+};
+
+#endif // CONN_SLAB_H
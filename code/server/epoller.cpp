@@ -28,6 +28,24 @@ bool Epoller::ModFd(int fd, uint32_t events) {
     return 0 == epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &ev);
 }
 
+bool Epoller::AddFd(int fd, uint32_t events, uint64_t data) {
+    if (fd < 0)
+        return false;
+    epoll_event ev = {0};
+    ev.data.u64 = data;
+    ev.events = events;
+    return 0 == epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev);
+}
+
+bool Epoller::ModFd(int fd, uint32_t events, uint64_t data) {
+    if (fd < 0)
+        return false;
+    epoll_event ev = {0};
+    ev.data.u64 = data;
+    ev.events = events;
+    return 0 == epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &ev);
+}
+
 bool Epoller::DelFd(int fd) {
     if (fd < 0)
         return false;
@@ -50,3 +68,8 @@ uint32_t Epoller::GetEvents(size_t i) const {
     assert(i < events_.size() && i >= 0);
     return events_[i].events; // 返回触发事件类型（EPOLLIN等）
 }
+
+uint64_t Epoller::GetEventData(size_t i) const {
+    assert(i < events_.size() && i >= 0);
+    return events_[i].data.u64;
+}
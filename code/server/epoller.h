@@ -18,10 +18,15 @@ public:
     bool ModFd(int fd, uint32_t events); // 修改fd监听事件类型
     bool DelFd(int fd);                  // 从epoll中删除fd
 
+    // 同上，但 epoll_event.data 中存放调用方给出的 64 位标识（如带代数的连接 id，低 32 位须为 fd）
+    bool AddFd(int fd, uint32_t events, uint64_t data);
+    bool ModFd(int fd, uint32_t events, uint64_t data);
+
     int Wait(int timeoutMs = -1); // 等待内核触发事件，默认-1为阻塞
 
-    int GetEventFd(size_t i) const;     // 获取第i个事件对应的fd
-    uint32_t GetEvents(size_t i) const; // 获取第i个事件的触发类型
+    int GetEventFd(size_t i) const;        // 获取第i个事件对应的fd
+    uint32_t GetEvents(size_t i) const;    // 获取第i个事件的触发类型
+    uint64_t GetEventData(size_t i) const; // 获取第i个事件的 64 位标识（用 fd 注册的为 fd 本身）
 
 private:
     int epollFd_;                            // epoll实例的文件描述符
@@ -0,0 +1,156 @@
+#include "listenhandoff.h"
+#include <sys/socket.h> // sendmsg / recvmsg，SCM_RIGHTS
+#include <sys/un.h>     // sockaddr_un
+#include <sys/stat.h>   // umask
+#include <poll.h>       // 等待确认的超时
+#include <fcntl.h>      // FD_CLOEXEC
+#include <unistd.h>     // close / unlink / getpid / geteuid
+#include <stdlib.h>     // getenv / unsetenv
+#include <string.h>     // memcpy / memset
+#include <errno.h>      // EINTR
+
+static const char ACK_BYTE = 'R'; // 新进程的接管确认
+
+static bool FillAddr(const std::string& path, sockaddr_un* addr) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr->sun_path)) {
+        return false;
+    }
+    memcpy(addr->sun_path, path.c_str(), path.size());
+    return true;
+}
+
+std::vector<int> ListenHandoff::FromSystemd() {
+    std::vector<int> fds;
+    const char* pid = getenv("LISTEN_PID");
+    const char* count = getenv("LISTEN_FDS");
+    if (!pid || !count || strtol(pid, nullptr, 10) != getpid()) {
+        return fds;
+    }
+    const int SD_LISTEN_FDS_START = 3; // systemd 约定从 fd 3 开始
+    int n = atoi(count);
+    for (int i = 0; i < n; i++) {
+        int fd = SD_LISTEN_FDS_START + i;
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        fds.push_back(fd);
+    }
+    unsetenv("LISTEN_PID");
+    unsetenv("LISTEN_FDS");
+    unsetenv("LISTEN_FDNAMES");
+    return fds;
+}
+
+int ListenHandoff::Request(const std::string& path, std::vector<int>* fds) {
+    sockaddr_un addr;
+    if (!FillAddr(path, &addr)) {
+        return -1;
+    }
+    int conn = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (conn < 0) {
+        return -1;
+    }
+    if (connect(conn, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(conn); // 没有旧进程：冷启动
+        return -1;
+    }
+    // 正文是 fd 个数，fd 本身放在 SCM_RIGHTS 控制消息中（内核在接收方创建新的 fd 指向同一个 socket）
+    int count = 0;
+    struct iovec iov = {&count, sizeof(count)};
+    union {
+        char buf[CMSG_SPACE(sizeof(int) * MAX_FDS)];
+        struct cmsghdr align;
+    } control;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+    ssize_t n;
+    do {
+        n = recvmsg(conn, &msg, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    struct cmsghdr* cmsg = n == sizeof(count) ? CMSG_FIRSTHDR(&msg) : nullptr;
+    if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+        close(conn);
+        return -1;
+    }
+    int received = static_cast<int>((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+    const int* data = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+    for (int i = 0; i < received; i++) {
+        fds->push_back(data[i]);
+    }
+    return conn;
+}
+
+void ListenHandoff::Ack(int conn) {
+    ssize_t n = write(conn, &ACK_BYTE, 1);
+    (void)n;
+    close(conn);
+}
+
+int ListenHandoff::Listen(const std::string& path) {
+    sockaddr_un addr;
+    if (!FillAddr(path, &addr)) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    unlink(addr.sun_path);
+    // socket 文件在 bind 时按 umask 创建，这里临时收紧为 0600，不留下其他用户可以连接的时间窗
+    mode_t oldMask = umask(0177);
+    int ret = bind(fd, (sockaddr*)&addr, sizeof(addr));
+    umask(oldMask);
+    if (ret < 0 || listen(fd, 1) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool ListenHandoff::PeerAllowed(int conn) {
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    if (getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0 || len != sizeof(cred)) {
+        return false;
+    }
+    return cred.uid == geteuid();
+}
+
+bool ListenHandoff::Serve(int conn, const std::vector<int>& fds, int timeoutMs) {
+    if (fds.empty() || fds.size() > static_cast<size_t>(MAX_FDS)) {
+        return false;
+    }
+    int count = static_cast<int>(fds.size());
+    struct iovec iov = {&count, sizeof(count)};
+    union {
+        char buf[CMSG_SPACE(sizeof(int) * MAX_FDS)];
+        struct cmsghdr align;
+    } control;
+    memset(&control, 0, sizeof(control));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * fds.size());
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+    memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+    if (sendmsg(conn, &msg, MSG_NOSIGNAL) != sizeof(count)) {
+        return false;
+    }
+    // 等待新进程初始化完成；它启动失败（连接被关闭或超时）时旧进程继续服务
+    struct pollfd pfd = {conn, POLLIN, 0};
+    int ret;
+    do {
+        ret = poll(&pfd, 1, timeoutMs);
+    } while (ret < 0 && errno == EINTR);
+    char ack = 0;
+    return ret > 0 && read(conn, &ack, 1) == 1 && ack == ACK_BYTE;
+}
@@ -0,0 +1,37 @@
+#ifndef LISTEN_HANDOFF_H
+#define LISTEN_HANDOFF_H
+
+#include <string> // 控制 socket 路径
+#include <vector> // 监听 fd 列表
+
+// 监听 socket 的继承（零停机重启）：
+//   - systemd socket activation：监听 socket 由 systemd 创建，经 LISTEN_PID / LISTEN_FDS 从 fd 3 起传入；
+//   - 进程间交接：旧进程在控制 socket（AF_UNIX）上等待，新进程连上后旧进程用 SCM_RIGHTS 把所有监听 fd 发过去，
+//     新进程初始化完成后回一个确认字节，旧进程收到确认才停止 accept 并开始排空连接。
+// 监听 socket 在整个过程中一直打开，内核 backlog 中的连接不会丢失，也不存在端口无人监听的时间窗。
+class ListenHandoff {
+public:
+    // 新进程：取得 systemd 传入的监听 fd（LISTEN_PID 不是本进程时为空），并清除相关环境变量，避免子进程误用
+    static std::vector<int> FromSystemd();
+
+    // 新进程：连接旧进程的控制 socket 并接收监听 fd；成功返回控制连接（启动完成后用 Ack 确认），
+    // 没有旧进程在监听（冷启动）或接收失败返回 -1
+    static int Request(const std::string& path, std::vector<int>* fds);
+
+    // 新进程：确认已接管监听（旧进程收到后开始排空），并关闭控制连接
+    static void Ack(int conn);
+
+    // 旧进程：在 path 上创建控制 socket（替换已有文件：旧进程的控制 socket 此时已无用）。
+    // socket 文件的权限为 0600，只有同一用户能连接
+    static int Listen(const std::string& path);
+
+    // 旧进程：连上来的对端（SO_PEERCRED）是否与本进程的有效用户相同。其他用户不能取得监听 fd，也不能让本进程排空
+    static bool PeerAllowed(int conn);
+
+    // 旧进程：把 fds 发给已连上的新进程，并等待其确认（最多 timeoutMs 毫秒），收到确认返回 true
+    static bool Serve(int conn, const std::vector<int>& fds, int timeoutMs);
+
+    static const int MAX_FDS = 64; // 一次交接的监听 fd 上限（SO_REUSEPORT 下每个事件循环一个）
+};
+
+#endif // LISTEN_HANDOFF_H
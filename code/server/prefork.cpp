@@ -0,0 +1,274 @@
+#include "prefork.h"
+#include <sys/mman.h>  // mmap 共享内存
+#include <sys/wait.h>  // waitpid
+#include <sys/prctl.h> // PR_SET_PDEATHSIG
+#include <string.h>    // strsignal / strerror
+#include <time.h>      // timespec
+#include <new>         // placement new
+
+static const int FAST_EXIT_MS = 1000;       // 启动后这么快就退出视为启动失败，延迟重启
+static const int MAX_BACKOFF_MS = 32000;    // 重启延迟上限
+static const int STATS_INTERVAL_MS = 60000; // 汇总统计写日志的间隔（也可以向 master 发 SIGUSR1 立即写一次）
+static const int STOP_GRACE_MS = 2000;      // 停止时在 drainTimeoutMs 之外再等待的时间，之后 SIGKILL
+
+WebServer* Prefork::worker_ = nullptr;
+
+int Prefork::Run(const ServerOptions& opts, const Factory& factory) {
+    if (opts.workerProcesses <= 0) {
+        std::unique_ptr<WebServer> server = factory(opts);
+        server->Start();
+        return 0;
+    }
+    Prefork master(opts, factory);
+    return master.Master_();
+}
+
+Prefork::Prefork(const ServerOptions& opts, const Factory& factory)
+    : opts_(opts), factory_(factory), stats_(nullptr), unixCreated_(false), masterPid_(getpid()) {
+    Worker w = {0, 0, 0, 0, 0};
+    workers_.assign(opts_.workerProcesses, w);
+    sigemptyset(&oldMask_);
+}
+
+Prefork::~Prefork() {
+    for (int fd : listenFds_) {
+        close(fd);
+    }
+    if (unixCreated_) {
+        unlink(opts_.unixPath.c_str());
+    }
+    if (stats_) {
+        munmap(stats_, sizeof(ServerStats) * workers_.size());
+    }
+}
+
+int Prefork::Master_() {
+    // master 单线程、同步写日志：fork 时不会有其他线程持有日志锁
+    Log::Instance()->init(1, "./log", ".master.log", 0);
+    LOG_INFO("========== Prefork master start, pid: %d, workers: %zu ==========", (int)masterPid_, workers_.size());
+    if (!opts_.handoffPath.empty()) {
+        LOG_WARN("handoffPath is not supported with workerProcesses, ignored");
+        opts_.handoffPath.clear();
+    }
+    // 统计只含原子计数，全零即初始状态；匿名共享映射在 fork 后父子进程看到同一份
+    void* mem = mmap(nullptr, sizeof(ServerStats) * workers_.size(), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                     -1, 0);
+    if (mem == MAP_FAILED) {
+        LOG_ERROR("mmap shared stats error: %s", strerror(errno));
+        return 1;
+    }
+    stats_ = static_cast<ServerStats*>(mem);
+    for (size_t i = 0; i < workers_.size(); i++) {
+        new (&stats_[i]) ServerStats();
+    }
+    if (!OpenListeners_()) {
+        LOG_ERROR("========== Prefork master init error! ==========");
+        return 1;
+    }
+
+    // 信号同步处理：阻塞后用 sigtimedwait 等待，主循环里没有异步信号处理函数
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGCHLD);
+    sigaddset(&set, SIGTERM);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGUSR1);
+    sigprocmask(SIG_BLOCK, &set, &oldMask_);
+
+    for (size_t i = 0; i < workers_.size(); i++) {
+        Spawn_(i);
+    }
+    int64_t nextStatsNs = ServerStats::NowNs() + static_cast<int64_t>(STATS_INTERVAL_MS) * 1000000;
+    while (true) {
+        // 最多等 1s，有计划中的重启时等到最近的那个
+        int64_t now = ServerStats::NowNs();
+        int64_t waitNs = 1000000000;
+        for (auto& w : workers_) {
+            if (w.pid == 0 && w.restartNs - now < waitNs) {
+                waitNs = std::max<int64_t>(w.restartNs - now, 0);
+            }
+        }
+        struct timespec ts = {static_cast<time_t>(waitNs / 1000000000), static_cast<long>(waitNs % 1000000000)};
+        int sig = sigtimedwait(&set, nullptr, &ts);
+        if (sig == SIGTERM || sig == SIGINT) {
+            LOG_INFO("Master got signal %d, stopping workers", sig);
+            break;
+        }
+        if (sig == SIGUSR1) {
+            LogStats_();
+        }
+        Reap_(false);
+        now = ServerStats::NowNs();
+        for (size_t i = 0; i < workers_.size(); i++) {
+            if (workers_[i].pid == 0 && workers_[i].restartNs <= now) {
+                Spawn_(i);
+            }
+        }
+        if (now >= nextStatsNs) {
+            LogStats_();
+            nextStatsNs = now + static_cast<int64_t>(STATS_INTERVAL_MS) * 1000000;
+        }
+    }
+    StopWorkers_();
+    LogStats_();
+    LOG_INFO("========== Prefork master exit ==========");
+    return 0;
+}
+
+// Unix 域 socket 不能用 SO_REUSEPORT 分给多个进程，由 master 创建一次、所有工作进程共享；
+// systemd 传入的监听 socket 同样由 master 接收后转给每个工作进程
+bool Prefork::OpenListeners_() {
+    listenFds_ = ListenHandoff::FromSystemd();
+    bool haveUnix = false;
+    for (int fd : listenFds_) {
+        sockaddr_storage addr;
+        socklen_t len = sizeof(addr);
+        if (getsockname(fd, (struct sockaddr*)&addr, &len) == 0 && addr.ss_family == AF_UNIX) {
+            haveUnix = true;
+        }
+    }
+    if (!opts_.unixPath.empty() && !haveUnix) {
+        int fd = WebServer::CreateUnixListenFd(opts_.unixPath, opts_.listenBacklog);
+        if (fd < 0) {
+            return false;
+        }
+        listenFds_.push_back(fd);
+        unixCreated_ = true;
+    }
+    LOG_INFO("Shared listen sockets: %zu (tcp sockets are per-worker SO_REUSEPORT unless inherited)", listenFds_.size());
+    return true;
+}
+
+void Prefork::Spawn_(int i) {
+    Worker& w = workers_[i];
+    pid_t pid = fork();
+    if (pid < 0) {
+        LOG_ERROR("Fork worker %d error: %s", i, strerror(errno));
+        w.restartNs = ServerStats::NowNs() + static_cast<int64_t>(FAST_EXIT_MS) * 1000000;
+        return;
+    }
+    if (pid == 0) {
+        RunWorker_(i); // 不返回
+    }
+    if (w.startNs != 0) {
+        w.restarts++;
+    }
+    w.pid = pid;
+    w.startNs = ServerStats::NowNs();
+    LOG_INFO("Worker %d started, pid: %d", i, (int)pid);
+}
+
+void Prefork::RunWorker_(int i) {
+    sigprocmask(SIG_SETMASK, &oldMask_, nullptr);
+    prctl(PR_SET_PDEATHSIG, SIGTERM); // master 意外退出时工作进程收到 SIGTERM，排空后退出
+    if (getppid() != masterPid_) {
+        exit(0); // master 在 prctl 之前就已退出
+    }
+    signal(SIGINT, SIG_IGN); // 终端 Ctrl-C 发给整个进程组：由 master 统一转成 SIGTERM，工作进程排空后退出
+    // 日志单例从 master 继承而来，仍指向 master 的文件：WebServer 按本进程的文件重新初始化之前不写（关闭日志时一直不写）
+    Log::Instance()->SetLevel(4);
+
+    ServerOptions opts = opts_;
+    opts.workerIndex = i;
+    opts.sharedStats = &stats_[i];
+    opts.listenFds = listenFds_;
+    std::unique_ptr<WebServer> server = factory_(opts);
+    worker_ = server.get();
+    signal(SIGTERM, OnWorkerTerm_);
+    server->Start();
+    worker_ = nullptr;
+    server.reset();
+    exit(0); // 走正常退出流程，让日志单例把异步队列写完
+}
+
+void Prefork::OnWorkerTerm_(int) {
+    if (worker_) {
+        worker_->Drain();
+    }
+}
+
+void Prefork::Reap_(bool stopping) {
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        for (size_t i = 0; i < workers_.size(); i++) {
+            Worker& w = workers_[i];
+            if (w.pid != pid) {
+                continue;
+            }
+            w.pid = 0;
+            int64_t now = ServerStats::NowNs();
+            int livedMs = static_cast<int>((now - w.startNs) / 1000000);
+            if (WIFSIGNALED(status)) {
+                LOG_WARN("Worker %zu (pid %d) killed by signal %d (%s) after %d ms", i, (int)pid, WTERMSIG(status),
+                         strsignal(WTERMSIG(status)), livedMs);
+            } else {
+                LOG_INFO("Worker %zu (pid %d) exited with status %d after %d ms", i, (int)pid, WEXITSTATUS(status),
+                         livedMs);
+            }
+            if (stopping) {
+                break;
+            }
+            // 连续快速退出时指数退避，正常运行过一段时间后的退出立即重启
+            w.backoffMs = livedMs < FAST_EXIT_MS ? std::min(std::max(w.backoffMs * 2, FAST_EXIT_MS), MAX_BACKOFF_MS) : 0;
+            w.restartNs = now + static_cast<int64_t>(w.backoffMs) * 1000000;
+            if (w.backoffMs > 0) {
+                LOG_WARN("Worker %zu exits too fast, restart in %d ms", i, w.backoffMs);
+            }
+            break;
+        }
+    }
+}
+
+void Prefork::StopWorkers_() {
+    for (auto& w : workers_) {
+        if (w.pid > 0) {
+            kill(w.pid, SIGTERM);
+        }
+    }
+    int64_t deadline = ServerStats::NowNs() + static_cast<int64_t>(opts_.drainTimeoutMs + STOP_GRACE_MS) * 1000000;
+    bool killed = false;
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGCHLD);
+    while (true) {
+        Reap_(true);
+        bool alive = false;
+        for (auto& w : workers_) {
+            alive = alive || w.pid > 0;
+        }
+        if (!alive) {
+            break;
+        }
+        if (!killed && ServerStats::NowNs() >= deadline) {
+            LOG_WARN("Workers not exited after drain timeout, killing");
+            for (auto& w : workers_) {
+                if (w.pid > 0) {
+                    kill(w.pid, SIGKILL);
+                }
+            }
+            killed = true;
+        }
+        struct timespec ts = {0, 100000000};
+        sigtimedwait(&set, nullptr, &ts);
+    }
+}
+
+void Prefork::LogStats_() {
+    ServerStats total;
+    total.Reset();
+    std::string perWorker;
+    int alive = 0;
+    int restarts = 0;
+    for (size_t i = 0; i < workers_.size(); i++) {
+        total.Add(stats_[i]);
+        perWorker += " " + std::to_string(stats_[i].requests.load(std::memory_order_relaxed));
+        alive += workers_[i].pid > 0 ? 1 : 0;
+        restarts += workers_[i].restarts;
+    }
+    LOG_INFO("Workers alive: %d/%zu, restarts: %d, requests: %llu (per worker:%s), latency(us) p50: %llu, p99: %llu, "
+             "p999: %llu, accepts: %llu",
+             alive, workers_.size(), restarts, (unsigned long long)total.requests.load(), perWorker.c_str(),
+             (unsigned long long)total.latency.Percentile(0.5), (unsigned long long)total.latency.Percentile(0.99),
+             (unsigned long long)total.latency.Percentile(0.999), (unsigned long long)total.accepts.load());
+}
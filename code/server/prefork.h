@@ -0,0 +1,62 @@
+#ifndef PREFORK_H
+#define PREFORK_H
+
+#include <functional>    // 工作进程中创建 WebServer 的工厂
+#include <memory>        // std::unique_ptr
+#include <vector>        // 工作进程表、共享的监听 fd
+#include <signal.h>      // sigset_t
+#include <sys/types.h>   // pid_t
+#include "webserver.h"   // WebServer、ServerOptions、ServerStats
+
+// 多进程模式（prefork）：master 进程只负责 fork 和看护工作进程，不处理连接。
+// 每个工作进程在 fork 之后才创建自己的 WebServer（事件循环、线程池、MySQL 连接、日志线程都不跨 fork），
+// 进程之间不共享堆、锁和分配器，一个进程崩溃只影响它自己的连接。
+//   - 监听：TCP 由各工作进程各自创建 SO_REUSEPORT socket，内核按连接哈希分配；
+//           Unix 域 socket（以及 systemd 传入的监听 socket）由 master 持有，所有工作进程共享，用 EPOLLEXCLUSIVE 避免惊群
+//   - 统计：master 在 fork 前用 mmap(MAP_SHARED | MAP_ANONYMOUS) 分配一组 ServerStats，第 i 个工作进程写第 i 个，
+//           master 定期汇总写入自己的日志（./log/日期.master.log），重启的进程接着累加，崩溃前的计数不丢
+//   - 看护：工作进程退出（崩溃或被杀）后由 master 重新 fork；启动后不到 1s 就退出的按 1s、2s、4s…（最多 32s）延迟重启，
+//           避免配置错误时反复 fork。master 收到 SIGTERM / SIGINT 后向工作进程转发 SIGTERM，工作进程排空后退出
+class Prefork {
+public:
+    typedef std::function<std::unique_ptr<WebServer>(const ServerOptions&)> Factory;
+
+    // opts.workerProcesses <= 0 时直接在当前进程创建并运行服务器；否则当前进程作为 master 运行到收到 SIGTERM / SIGINT，
+    // 每个工作进程用 factory(该进程的 ServerOptions) 创建 WebServer 后 Start()。返回值可作为进程退出码
+    static int Run(const ServerOptions& opts, const Factory& factory);
+
+private:
+    struct Worker {
+        pid_t pid;         // 0 表示当前没有运行
+        int64_t startNs;   // 本次启动时间（0 表示还没启动过）
+        int backoffMs;     // 上次的重启延迟（连续快速退出时翻倍）
+        int64_t restartNs; // pid 为 0 时计划重启的时间
+        int restarts;      // 累计重启次数
+    };
+
+    Prefork(const ServerOptions& opts, const Factory& factory);
+    ~Prefork();
+
+    int Master_();                  // master 主循环
+    void Spawn_(int i);             // fork 第 i 个工作进程
+    void RunWorker_(int i);         // 工作进程：创建并运行 WebServer，不返回
+    void Reap_(bool stopping);      // 回收退出的工作进程，未在停止时安排重启
+    void StopWorkers_();            // 向所有工作进程发送 SIGTERM 并等待退出（超时后 SIGKILL）
+    void LogStats_();               // 汇总共享内存中的统计写入日志
+    bool OpenListeners_();          // 创建 / 继承所有工作进程共享的监听 socket
+
+    static void OnWorkerTerm_(int); // 工作进程的 SIGTERM：开始排空
+
+    ServerOptions opts_;
+    Factory factory_;
+    std::vector<Worker> workers_;
+    ServerStats* stats_;          // 共享内存中的统计槽，每个工作进程一个
+    std::vector<int> listenFds_;  // 共享的监听 socket
+    bool unixCreated_;            // Unix 域 socket 文件由 master 创建（退出时删除）
+    sigset_t oldMask_;            // master 阻塞信号前的信号掩码（工作进程恢复）
+    pid_t masterPid_;
+
+    static WebServer* worker_;    // 工作进程中运行的 WebServer（供信号处理函数使用）
+};
+
+#endif // PREFORK_H
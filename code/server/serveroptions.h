@@ -0,0 +1,170 @@
+#ifndef SERVER_OPTIONS_H
+#define SERVER_OPTIONS_H
+
+#include <stddef.h>   // size_t
+#include <string>     // CPU 列表
+#include <vector>     // 继承的监听 fd
+#include <functional> // 请求体转存回调
+
+#include "../http/httpmultipart.h" // 上传文件回调的 part 信息
+
+struct ServerStats;
+class HttpRequest;
+class HttpResponse;
+class HttpRouter;
+
+// 单 Reactor（reactorNum == 0）下读写任务交给线程池的方式
+enum DISPATCH_MODE {
+    DISPATCH_POOL = 0, // 共享任务队列：任意空闲工作线程取任务，同一连接的读、写可能落在不同线程
+    DISPATCH_AFFINITY, // 连接亲和：按 fd 哈希固定到一个工作线程（各自独立的队列），读 -> 处理 -> 写连续完成
+    DISPATCH_PROACTOR, // Proactor：事件循环完成全部非阻塞读写，只把读完整的请求交给工作线程解析、生成响应，
+                       // 结果经无锁完成队列 + eventfd 交回事件循环（工作线程不再调用 epoll_ctl，慢客户端也不占用工作线程）
+};
+
+// 过载时对新连接的处理方式
+enum SHED_MODE {
+    SHED_503 = 0, // accept 后立即回复预先生成的 503 并关闭（客户端能快速失败/重试）
+    SHED_PAUSE,   // 暂停 accept（监听 socket 移出 epoll），新连接留在内核 backlog 中，满了由内核拒绝
+};
+
+// WebServer 的可选配置（构造函数位置参数之外的扩展项），默认值即原有的单 Reactor + 线程池模型
+struct ServerOptions {
+    // 事件循环（Reactor）数量：
+    //   0  —— 单 Reactor：主线程一个 Epoller 负责 accept/定时器/分发，读写交给线程池
+    //   >0 —— 多 Reactor：每个线程独占 Epoller、HeapTimer 和自己的一批连接，读写在本线程内完成
+    int reactorNum = 0;
+
+    // 多 Reactor 下监听方式：
+    //   false —— 每个 Reactor 各自创建一个 SO_REUSEPORT 监听 socket，由内核按四元组哈希分配连接
+    //   true  —— 所有 Reactor 共享一个监听 socket，用 EPOLLEXCLUSIVE 避免惊群
+    bool sharedListen = false;
+
+    // 主从 Reactor：reactorNum > 0 时，主线程的主 Reactor 只负责 accept，
+    // 再把新连接分给 reactorNum 个从 Reactor（放入其待处理队列并用 eventfd 唤醒），此时忽略 sharedListen
+    bool mainSubReactor = false;
+
+    // 主从 Reactor 下新连接的分配策略：false —— 轮询；true —— 选择当前连接数最少的从 Reactor
+    bool leastLoaded = false;
+
+    // I/O 后端：true 时每个事件循环使用 io_uring（accept/recv/writev/close + provided buffer ring），
+    // 请求在循环线程内处理；内核不支持时自动回退到 epoll
+    bool ioUring = false;
+
+    // 单 Reactor + 线程池下的任务分发方式，见 DISPATCH_MODE
+    DISPATCH_MODE dispatch = DISPATCH_POOL;
+
+    // 自适应内联阈值（字节，0 关闭）：单 Reactor + 线程池下，事件循环线程先读取数据，
+    // 若读缓冲区中已有完整的轻量请求（GET/HEAD，不走数据库）且生成的响应不超过该值，就在循环线程内处理并写出，
+    // 省掉任务封装、加锁、唤醒和线程切换；其余请求照常交给线程池。建议不超过 socket 发送缓冲区大小
+    size_t inlineThreshold = 0;
+
+    // 绑核（Linux cpulist 格式，如 "0-3,8"，空串表示不绑定）：
+    //   reactorCpus —— 第 i 个事件循环线程绑定到列表中第 i % n 个 CPU，
+    //                  并让该循环的连接槽优先从这个 CPU 所在的 NUMA 节点分配
+    //   workerCpus  —— 线程池（或连接亲和模式的各工作线程）第 i 个线程绑定到第 i % n 个 CPU
+    //   logCpu      —— 异步日志写线程绑定的 CPU（-1 不绑定）
+    // 双路服务器上把同一组事件循环和工作线程放在同一个 socket 上，可以减少跨节点的缓存和内存访问
+    std::string reactorCpus;
+    std::string workerCpus;
+    int logCpu = -1;
+
+    // 忙轮询预算（微秒，0 关闭）：epoll 事件循环在阻塞前先用非阻塞 epoll_wait 自旋这么久（不超过下一个定时器），
+    // 有事件立即处理，省掉空闲时新请求到来的一次睡眠/唤醒；同时对新连接设置 SO_BUSY_POLL / SO_PREFER_BUSY_POLL。
+    // 以 CPU 换延迟，自旋消耗见 ServerStats::spinNs；io_uring 后端不使用
+    int busyPollUs = 0;
+
+    // 过载保护（只对单 Reactor + 线程池的各种分发方式生效）：
+    // 线程池排队任务数 >= queueHighWater，或队首任务已排队 >= queueDelayHighUs 微秒时进入过载；
+    // 排队数 <= queueLowWater 且排队时间 < queueDelayHighUs / 2 时恢复。过载期间按 shedMode 处理新连接，
+    // 已建立的连接不受影响——提前拒绝一部分新连接，让已接纳的请求保持正常延迟，而不是所有请求一起变慢
+    int queueHighWater = 0;   // 0 不按排队数判断
+    int queueLowWater = 0;    // 恢复水位（应小于 queueHighWater）
+    int queueDelayHighUs = 0; // 0 不按排队时间判断
+    SHED_MODE shedMode = SHED_503;
+
+    // 按客户端 IP 限流（在 accept 之后、HttpConn 初始化之前检查，被拒绝的连接收到预先生成的 429 后关闭）：
+    //   maxConnPerIp —— 单个 IP 的并发连接数上限（0 不限）
+    //   ipRate       —— 单个 IP 的令牌桶补充速率（请求/秒，0 不限），每个新请求取走一个令牌；
+    //                   令牌用完的 IP 新请求和新连接都被拒绝
+    //   ipBurst      —— 令牌桶容量，即允许的突发请求数（<= 0 时取 ipRate）
+    int maxConnPerIp = 0;
+    double ipRate = 0;
+    double ipBurst = 0;
+
+    // socket 参数（效果见退出时日志中的内核计数器差值，见 TcpCounters）：
+    //   listenBacklog  —— listen() 的 backlog，连接突发时 accept 队列满会丢 SYN，客户端要等秒级的重传
+    //                     （实际上限为 net.core.somaxconn）
+    //   deferAcceptSec —— TCP_DEFER_ACCEPT（秒，0 关闭）：握手完成后等到客户端发来数据才唤醒 accept，
+    //                     只连不发的连接不占用事件循环；超时后内核仍会交付该连接
+    //   fastOpenQueue  —— TCP_FASTOPEN 的待处理队列长度（0 关闭）：支持 TFO 的客户端重连时在 SYN 中携带请求，省一个 RTT
+    //                     （还需 net.ipv4.tcp_fastopen 开启服务端位，即 & 2）
+    //   tcpNoDelay     —— 对新连接设置 TCP_NODELAY，关闭 Nagle，响应尾部的小段不再等上一段的 ACK
+    //   tcpCork        —— 一次 writev 含多段（带文件内容或流水线的多个响应）时用 TCP_CORK 包住，合并成满 MSS 的段
+    //                     （io_uring 后端的异步 writev 不使用）
+    int listenBacklog = 1024;
+    int deferAcceptSec = 0;
+    int fastOpenQueue = 0;
+    bool tcpNoDelay = false;
+    bool tcpCork = false;
+
+    // Unix 域监听（本机反向代理经 AF_UNIX 转发，省掉回环 TCP 协议栈）：
+    //   unixPath —— 非空时在该路径上额外监听一个 AF_UNIX stream socket（启动时删除残留的同名 socket 文件，退出时删除）
+    //   unixOnly —— 只监听 unixPath，不监听 TCP 端口
+    // 连接从 AddClient_ 起与 TCP 连接走同一套流程；TCP 专属的选项（nodelay/cork/按 IP 限流）不作用于 Unix 域连接
+    std::string unixPath;
+    bool unixOnly = false;
+
+    // HTTP/1.1 流水线：客户端在一个连接上连发多个请求时，读缓冲区中已完整的请求按顺序一次处理，
+    // 响应排成一批用一次 writev 写出。pipelineDepth 为每批最多的请求数（1 ~ HttpConn::MAX_PIPELINE，1 即逐个处理），
+    // 剩下的请求在这一批写完后接着处理
+    int pipelineDepth = 16;
+
+    // 请求体（按 Content-Length 接收）：
+    //   maxBodySize  —— 请求体上限（字节），超过时不接收请求体，回复 413 并关闭连接
+    //   bodyMemLimit —— 不超过该值的请求体在读缓冲区中收齐后再处理；更大的请求体边到达边从读缓冲区取走，
+    //                   按 HttpRequest::BODY_CHUNK 分段转存，每个连接的内存占用与上传大小无关
+    //   bodyTempDir  —— 转存目录：请求体写入其中的匿名临时文件（O_TMPFILE，关闭即删除，见 HttpRequest::BodyFd）
+    //   bodyHandler  —— 非空时请求体转存给该回调而不是临时文件（签名与用法见 HttpRequest::BodyHandler）
+    //   partHandler  —— multipart/form-data 请求体边到达边解析：普通字段可用 GetPost 取，上传的文件默认各写进
+    //                   bodyTempDir 下的匿名临时文件（见 HttpRequest::Uploads）；非空时文件内容改为分段交给该回调
+    //                   （签名与用法见 HttpRequest::PartHandler）。设置了 bodyHandler 时不解析
+    size_t maxBodySize = 64 << 20;
+    size_t bodyMemLimit = 64 << 10;
+    std::string bodyTempDir = "/tmp";
+    std::function<bool(const HttpRequest&, const char*, size_t)> bodyHandler;
+    std::function<bool(const HttpRequest&, const MultipartParser::Part&, const char*, size_t)> partHandler;
+
+    // 请求处理回调（签名与用法见 HttpConn::Handler）：请求完整后先交给它，返回 false 的按路径返回静态文件。
+    // 可以用 HttpResponse::InitGenerated 返回边生成边写出的内容（chunked 编码，HTTP/1.0 客户端以关闭连接结束）
+    std::function<bool(const HttpRequest&, HttpResponse&)> requestHandler;
+
+    // 路由注册：启动时在网站自带页面的路由（HttpConn::AddSiteRoutes）之后调用一次，在其中 router.Get / Post / Any / Add
+    // 注册动态接口（精确、":name" 参数、"*name" 前缀，见 HttpRouter）。同一方法和模式再次注册会替换自带的处理函数。
+    // 请求先按方法和路径查路由表，再交给 requestHandler，最后按路径返回静态文件。
+    // 注意 GET/HEAD 在开启 inlineThreshold 时可能在事件循环线程中处理，这类处理函数不要阻塞
+    std::function<void(HttpRouter&)> routes;
+
+    // 零停机重启：
+    //   handoffPath    —— 非空时在该路径上开一个 AF_UNIX 控制 socket。新进程启动时先连接它，经 SCM_RIGHTS 继承旧进程的
+    //                     全部监听 socket（没有旧进程则正常创建），初始化完成后确认；旧进程收到确认后停止 accept 并排空连接
+    //                     （systemd socket activation 传入的 LISTEN_FDS 总是优先使用，不需要此项）
+    //   drainTimeoutMs —— 排空期限：停止 accept 后先关闭空闲的长连接，进行中的请求写完响应后关闭连接（不再保持长连接），
+    //                     到期仍未关闭的连接直接断开。WebServer::Drain() 也会触发排空（如收到 SIGTERM 时）
+    std::string handoffPath;
+    int drainTimeoutMs = 10000;
+
+    // 多进程（Prefork，见 prefork.h）：workerProcesses > 0 时 Prefork::Run 以当前进程为 master，fork 出这么多个工作进程，
+    // 每个进程各自运行一个完整的 WebServer（事件循环、线程池、MySQL 连接池都在 fork 之后创建），master 负责重启崩溃的进程；
+    // 构造函数的 connPoolNum 此时是所有进程合计的连接数。不能与 handoffPath 同时使用
+    int workerProcesses = 0;
+
+    // 以下由 Prefork 为每个工作进程填写，一般不需要手动设置：
+    //   workerIndex —— 工作进程编号（-1 表示不是工作进程），决定日志文件名（./log/日期.w编号.log）
+    //   sharedStats —— master 共享内存中本进程的统计槽（为空时使用 WebServer 自己的统计）
+    //   listenFds   —— master 创建或从 systemd 继承、由所有工作进程共享的监听 socket（优先于 LISTEN_FDS 和 handoffPath）
+    int workerIndex = -1;
+    ServerStats* sharedStats = nullptr;
+    std::vector<int> listenFds;
+};
+
+#endif // SERVER_OPTIONS_H
@@ -0,0 +1,100 @@
+#include "serverstats.h"
+
+// 0..7 线性分桶；更大的值按最高位所在区间 [2^e, 2^(e+1)) 再取其后 SUB_BITS 位作为子桶
+int LatencyHistogram::Index_(uint64_t us) {
+    if (us < (1u << SUB_BITS)) {
+        return static_cast<int>(us);
+    }
+    int e = 63 - __builtin_clzll(us);
+    int sub = static_cast<int>((us >> (e - SUB_BITS)) & ((1u << SUB_BITS) - 1));
+    return ((e - SUB_BITS + 1) << SUB_BITS) + sub;
+}
+
+uint64_t LatencyHistogram::UpperBound_(int idx) {
+    if (idx < (1 << SUB_BITS)) {
+        return static_cast<uint64_t>(idx);
+    }
+    int e = (idx >> SUB_BITS) + SUB_BITS - 1;
+    uint64_t sub = static_cast<uint64_t>(idx & ((1 << SUB_BITS) - 1));
+    uint64_t width = 1ull << (e - SUB_BITS);
+    return (1ull << e) + (sub + 1) * width - 1;
+}
+
+void LatencyHistogram::Record(uint64_t us) {
+    buckets_[Index_(us)].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::Count() const {
+    uint64_t n = 0;
+    for (int i = 0; i < BUCKET_NUM; i++) {
+        n += buckets_[i].load(std::memory_order_relaxed);
+    }
+    return n;
+}
+
+uint64_t LatencyHistogram::Percentile(double p) const {
+    uint64_t total = Count();
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(p * total + 0.5); // 第 rank 个（从 1 开始）记录所在的桶
+    if (rank < 1) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_NUM; i++) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return UpperBound_(i);
+        }
+    }
+    return UpperBound_(BUCKET_NUM - 1);
+}
+
+void LatencyHistogram::Reset() {
+    for (int i = 0; i < BUCKET_NUM; i++) {
+        buckets_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::Add(const LatencyHistogram& other) {
+    for (int i = 0; i < BUCKET_NUM; i++) {
+        buckets_[i].fetch_add(other.buckets_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+void ServerStats::Reset() {
+    requests.store(0, std::memory_order_relaxed);
+    inlined.store(0, std::memory_order_relaxed);
+    offloaded.store(0, std::memory_order_relaxed);
+    spinNs.store(0, std::memory_order_relaxed);
+    spinHits.store(0, std::memory_order_relaxed);
+    spinMisses.store(0, std::memory_order_relaxed);
+    overloads.store(0, std::memory_order_relaxed);
+    shed.store(0, std::memory_order_relaxed);
+    pauses.store(0, std::memory_order_relaxed);
+    ipConnRejects.store(0, std::memory_order_relaxed);
+    ipRateRejects.store(0, std::memory_order_relaxed);
+    accepts.store(0, std::memory_order_relaxed);
+    acceptWakeups.store(0, std::memory_order_relaxed);
+    corked.store(0, std::memory_order_relaxed);
+    latency.Reset();
+}
+
+void ServerStats::Add(const ServerStats& other) {
+    requests.fetch_add(other.requests.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    inlined.fetch_add(other.inlined.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    offloaded.fetch_add(other.offloaded.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    spinNs.fetch_add(other.spinNs.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    spinHits.fetch_add(other.spinHits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    spinMisses.fetch_add(other.spinMisses.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    overloads.fetch_add(other.overloads.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    shed.fetch_add(other.shed.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    pauses.fetch_add(other.pauses.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    ipConnRejects.fetch_add(other.ipConnRejects.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    ipRateRejects.fetch_add(other.ipRateRejects.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    accepts.fetch_add(other.accepts.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    acceptWakeups.fetch_add(other.acceptWakeups.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    corked.fetch_add(other.corked.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    latency.Add(other.latency);
+}
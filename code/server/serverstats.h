@@ -0,0 +1,63 @@
+#ifndef SERVER_STATS_H
+#define SERVER_STATS_H
+
+#include <atomic>   // 计数器，多线程无锁累加
+#include <chrono>   // steady_clock，请求耗时
+#include <stdint.h> // uint64_t
+#include <stddef.h> // size_t
+
+// 对数分桶的延迟直方图（单位：微秒）：每个 2 的幂区间再均分 8 个子桶，分位数误差不超过 12.5%
+// 只含原子计数，全零即为初始状态，可以放在共享内存中
+class LatencyHistogram {
+public:
+    void Record(uint64_t us);                // 记录一次耗时
+    uint64_t Count() const;                  // 记录总次数
+    uint64_t Percentile(double p) const;     // 第 p 分位（0 < p <= 1）所在桶的上界，无记录时返回 0
+    void Reset();                            // 清零
+    void Add(const LatencyHistogram& other); // 累加另一个直方图（多进程汇总）
+
+    static const int SUB_BITS = 3;                   // 每个 2 的幂区间的子桶数 = 1 << SUB_BITS
+    static const int BUCKET_NUM = 64 << SUB_BITS;    // 覆盖全部 uint64_t 取值
+
+private:
+    static int Index_(uint64_t us);        // 耗时 -> 桶下标
+    static uint64_t UpperBound_(int idx);  // 桶下标 -> 该桶的上界
+
+    std::atomic<uint64_t> buckets_[BUCKET_NUM];
+};
+
+// 服务器运行统计：请求数和请求耗时（从读事件到达到响应写完）、分发方式、忙轮询开销、过载保护、按 IP 限流、socket 参数
+struct ServerStats {
+    std::atomic<uint64_t> requests;      // 已完成（响应写完）的请求数
+    LatencyHistogram latency;            // 请求耗时分布
+    std::atomic<uint64_t> inlined;       // 在事件循环线程内处理的读事件数（自适应内联）
+    std::atomic<uint64_t> offloaded;     // 交给线程池处理的读事件数
+    std::atomic<uint64_t> spinNs;        // 忙轮询自旋累计耗时（纳秒，约等于自旋烧掉的 CPU 时间）
+    std::atomic<uint64_t> spinHits;      // 自旋期间等到事件的次数
+    std::atomic<uint64_t> spinMisses;    // 自旋预算用完、转入阻塞等待的次数
+    std::atomic<uint64_t> overloads;     // 进入过载状态的次数
+    std::atomic<uint64_t> shed;          // 过载期间以 503 拒绝的连接数
+    std::atomic<uint64_t> pauses;        // 过载期间暂停 accept 的次数
+    std::atomic<uint64_t> ipConnRejects; // 因单 IP 并发连接数超限被拒绝的连接数
+    std::atomic<uint64_t> ipRateRejects; // 因单 IP 令牌用完被拒绝的连接数和请求数
+    std::atomic<uint64_t> accepts;       // accept 到的连接数
+    std::atomic<uint64_t> acceptWakeups; // 监听 socket 的可读事件数（TCP_DEFER_ACCEPT 下每次唤醒都有数据可读）
+    std::atomic<uint64_t> corked;        // 用 TCP_CORK 包住写出的响应数
+
+    // 单调时钟当前时间（纳秒），0 保留作“未开始”
+    static int64_t NowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count() | 1;
+    }
+
+    // 记录一个在 startNs 开始、此刻完成的请求
+    void RecordRequest(int64_t startNs, uint64_t count = 1) { // count：一起写出的流水线请求数，共用一个耗时
+        requests.fetch_add(count, std::memory_order_relaxed);
+        latency.Record(static_cast<uint64_t>(NowNs() - startNs) / 1000);
+    }
+
+    void Reset();
+    void Add(const ServerStats& other); // 累加另一份统计（Prefork 的 master 汇总各工作进程）
+};
+
+#endif // SERVER_STATS_H
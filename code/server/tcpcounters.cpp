@@ -0,0 +1,61 @@
+#include "tcpcounters.h"
+#include <stdio.h>  // fopen / fgets
+#include <stdlib.h> // strtoull
+#include <string.h> // strncmp / strtok_r
+
+// /proc/net/{netstat,snmp} 中每组计数器占两行：“前缀: 名字...” 和 “前缀: 数值...”，按列对应
+static bool ReadProcTable(const char* path, const char* prefix, const char* const* names, uint64_t* const* values,
+                          int count) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        return false;
+    }
+    size_t prefixLen = strlen(prefix);
+    char head[8192]; // TcpExt 的名字行有 2KB 以上，留足余量
+    char data[8192];
+    bool found = false;
+    while (!found && fgets(head, sizeof(head), fp)) {
+        if (strncmp(head, prefix, prefixLen) != 0 || !fgets(data, sizeof(data), fp)) {
+            continue;
+        }
+        char* headSave = nullptr;
+        char* dataSave = nullptr;
+        char* name = strtok_r(head + prefixLen, " \n", &headSave);
+        char* value = strtok_r(data + prefixLen, " \n", &dataSave);
+        for (; name && value; name = strtok_r(nullptr, " \n", &headSave), value = strtok_r(nullptr, " \n", &dataSave)) {
+            for (int i = 0; i < count; i++) {
+                if (strcmp(name, names[i]) == 0) {
+                    *values[i] = strtoull(value, nullptr, 10);
+                }
+            }
+        }
+        found = true;
+    }
+    fclose(fp);
+    return found;
+}
+
+bool TcpCounters::Read() {
+    static const char* const EXT_NAMES[] = {"ListenOverflows", "ListenDrops", "TCPFastOpenPassive",
+                                            "TCPFastOpenPassiveFail", "TCPFastOpenListenOverflow"};
+    uint64_t* const extValues[] = {&listenOverflows, &listenDrops, &fastOpenPassive, &fastOpenFail,
+                                   &fastOpenOverflow};
+    static const char* const TCP_NAMES[] = {"PassiveOpens", "OutSegs", "RetransSegs"};
+    uint64_t* const tcpValues[] = {&passiveOpens, &outSegs, &retransSegs};
+    bool ext = ReadProcTable("/proc/net/netstat", "TcpExt:", EXT_NAMES, extValues, 5);
+    bool tcp = ReadProcTable("/proc/net/snmp", "Tcp:", TCP_NAMES, tcpValues, 3);
+    return ext && tcp;
+}
+
+TcpCounters TcpCounters::Since(const TcpCounters& old) const {
+    TcpCounters diff;
+    diff.listenOverflows = listenOverflows - old.listenOverflows;
+    diff.listenDrops = listenDrops - old.listenDrops;
+    diff.fastOpenPassive = fastOpenPassive - old.fastOpenPassive;
+    diff.fastOpenFail = fastOpenFail - old.fastOpenFail;
+    diff.fastOpenOverflow = fastOpenOverflow - old.fastOpenOverflow;
+    diff.passiveOpens = passiveOpens - old.passiveOpens;
+    diff.outSegs = outSegs - old.outSegs;
+    diff.retransSegs = retransSegs - old.retransSegs;
+    return diff;
+}
@@ -0,0 +1,23 @@
+#ifndef TCP_COUNTERS_H
+#define TCP_COUNTERS_H
+
+#include <stdint.h> // uint64_t
+
+// 内核 TCP 计数器快照（/proc/net/netstat 的 TcpExt、/proc/net/snmp 的 Tcp），
+// 启动时和退出时各取一次，差值反映 backlog、TCP_FASTOPEN、TCP_NODELAY / TCP_CORK 等 socket 选项的效果。
+// 计数器是整个网络命名空间的，机器上只跑这一个服务时才能直接归到本进程
+struct TcpCounters {
+    uint64_t listenOverflows = 0;   // accept 队列满被丢弃的连接（backlog 太小）
+    uint64_t listenDrops = 0;       // 在监听 socket 上被丢弃的 SYN/连接（含 listenOverflows）
+    uint64_t fastOpenPassive = 0;   // 带 SYN 数据、以 TCP Fast Open 建立的被动连接
+    uint64_t fastOpenFail = 0;      // TFO cookie 校验失败、退回普通三次握手的次数
+    uint64_t fastOpenOverflow = 0;  // TFO 队列（TCP_FASTOPEN 的 qlen）满而退回普通握手的次数
+    uint64_t passiveOpens = 0;      // 被动建立的连接数
+    uint64_t outSegs = 0;           // 发出的 TCP 段数（每个响应的段数反映 Nagle / cork 的合并效果）
+    uint64_t retransSegs = 0;       // 重传的 TCP 段数
+
+    bool Read();                                      // 读取当前值，/proc 不可读时返回 false
+    TcpCounters Since(const TcpCounters& old) const; // 与更早的快照之差
+};
+
+#endif // TCP_COUNTERS_H
@@ -0,0 +1,339 @@
+#include "uringer.h"
+
+#include <sys/mman.h>    // mmap() 映射 SQ/CQ 环
+#include <sys/syscall.h> // __NR_io_uring_*
+#include <unistd.h>      // syscall() / close()
+#include <string.h>      // memset()
+#include <errno.h>       // errno
+#include <assert.h>      // assert()
+
+#ifdef HAVE_IO_URING
+
+static const unsigned short BUF_GROUP = 0; // provided buffer ring 的组号（每个 Uringer 只注册一组）
+
+Uringer::Uringer(unsigned entries, unsigned bufCount, unsigned bufSize)
+    : ringFd_(-1), sqes_(nullptr), sqLocalTail_(0), cqReady_(0), sqRing_(MAP_FAILED), sqRingSize_(0),
+      cqRing_(MAP_FAILED), cqRingSize_(0), sqesSize_(0), bufRing_(nullptr), bufRingSize_(0), bufs_(nullptr),
+      bufCount_(bufCount), bufSize_(bufSize) {
+    assert(bufCount > 0 && (bufCount & (bufCount - 1)) == 0); // buffer ring 大小必须是 2 的幂
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    ringFd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &p));
+    if (ringFd_ < 0) {
+        return; // 内核不支持或被 seccomp 禁止，IsOpen() 返回 false
+    }
+
+    // 映射 SQ / CQ 环（支持 SINGLE_MMAP 的内核上两者共用一段映射）
+    sqRingSize_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cqRingSize_ = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single && cqRingSize_ > sqRingSize_) {
+        sqRingSize_ = cqRingSize_;
+    }
+    sqRing_ = mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_,
+                   IORING_OFF_SQ_RING);
+    if (sqRing_ == MAP_FAILED) {
+        close(ringFd_);
+        ringFd_ = -1;
+        return;
+    }
+    cqRing_ = single ? sqRing_
+                     : mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_,
+                            IORING_OFF_CQ_RING);
+    sqesSize_ = p.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_,
+                      IORING_OFF_SQES);
+    if (cqRing_ == MAP_FAILED || sqes == MAP_FAILED) {
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, sqesSize_);
+        }
+        close(ringFd_);
+        ringFd_ = -1;
+        return;
+    }
+    sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(sqRing_);
+    sqHead_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+    sqTail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    sqMask_ = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    sqArray_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    sqLocalTail_ = *sqTail_;
+
+    char* cq = static_cast<char*>(cqRing_);
+    cqHead_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    cqMask_ = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + p.cq_off.cqes);
+
+    // 注册 provided buffer ring：环本身按页对齐映射，缓冲区连续分配
+    bufRingSize_ = bufCount_ * sizeof(struct io_uring_buf);
+    void* ring = mmap(nullptr, bufRingSize_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    bufs_ = new char[static_cast<size_t>(bufCount_) * bufSize_];
+    if (ring == MAP_FAILED) {
+        close(ringFd_);
+        ringFd_ = -1;
+        return;
+    }
+    bufRing_ = static_cast<struct io_uring_buf_ring*>(ring);
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(bufRing_);
+    reg.ring_entries = bufCount_;
+    reg.bgid = BUF_GROUP;
+    if (syscall(__NR_io_uring_register, ringFd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        close(ringFd_); // 内核 < 5.19，不支持 buffer ring
+        ringFd_ = -1;
+        return;
+    }
+    // 注意：C++ 下 io_uring_buf_ring::bufs 的柔性数组被展开成带空结构体占位的形式，偏移不为 0，
+    // 因此直接把环首地址当作 io_uring_buf 数组使用（与内核布局一致）
+    struct io_uring_buf* ringBufs = reinterpret_cast<struct io_uring_buf*>(bufRing_);
+    for (unsigned bid = 0; bid < bufCount_; bid++) {
+        struct io_uring_buf* buf = &ringBufs[bid];
+        buf->addr = reinterpret_cast<uint64_t>(bufs_ + static_cast<size_t>(bid) * bufSize_);
+        buf->len = bufSize_;
+        buf->bid = static_cast<unsigned short>(bid);
+    }
+    __atomic_store_n(&bufRing_->tail, static_cast<unsigned short>(bufCount_), __ATOMIC_RELEASE);
+}
+
+Uringer::~Uringer() {
+    if (ringFd_ >= 0) {
+        close(ringFd_);
+    }
+    if (sqes_) {
+        munmap(sqes_, sqesSize_);
+    }
+    if (cqRing_ != MAP_FAILED && cqRing_ != sqRing_) {
+        munmap(cqRing_, cqRingSize_);
+    }
+    if (sqRing_ != MAP_FAILED) {
+        munmap(sqRing_, sqRingSize_);
+    }
+    if (bufRing_) {
+        munmap(bufRing_, bufRingSize_);
+    }
+    delete[] bufs_;
+}
+
+bool Uringer::IsOpen() const {
+    return ringFd_ >= 0;
+}
+
+// io_uring_enter：提交 toSubmit 个 SQE，并等待至少 minComplete 个完成事件（timeoutMs < 0 表示不限时）
+int Uringer::Enter_(unsigned toSubmit, unsigned minComplete, int timeoutMs) {
+    unsigned flags = 0;
+    struct io_uring_getevents_arg arg;
+    struct __kernel_timespec ts;
+    memset(&arg, 0, sizeof(arg));
+    if (minComplete > 0) {
+        flags |= IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+        if (timeoutMs >= 0) {
+            ts.tv_sec = timeoutMs / 1000;
+            ts.tv_nsec = (timeoutMs % 1000) * 1000000LL;
+            arg.ts = reinterpret_cast<uint64_t>(&ts);
+        }
+    }
+    return static_cast<int>(syscall(__NR_io_uring_enter, ringFd_, toSubmit, minComplete, flags,
+                                    minComplete > 0 ? &arg : nullptr, minComplete > 0 ? sizeof(arg) : 0));
+}
+
+// 取一个空闲 SQE；提交队列已满时先把已填写的提交给内核
+struct io_uring_sqe* Uringer::GetSqe_() {
+    unsigned head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    if (sqLocalTail_ - head > *sqMask_) {
+        __atomic_store_n(sqTail_, sqLocalTail_, __ATOMIC_RELEASE);
+        Enter_(sqLocalTail_ - head, 0, 0);
+        head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+        if (sqLocalTail_ - head > *sqMask_) {
+            return nullptr;
+        }
+    }
+    unsigned idx = sqLocalTail_ & *sqMask_;
+    struct io_uring_sqe* sqe = &sqes_[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sqArray_[idx] = idx;
+    sqLocalTail_++;
+    return sqe;
+}
+
+bool Uringer::Accept(int fd, sockaddr* addr, socklen_t* len, uint64_t data) {
+    struct io_uring_sqe* sqe = GetSqe_();
+    if (!sqe) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(addr);
+    sqe->addr2 = reinterpret_cast<uint64_t>(len);
+    sqe->user_data = data;
+    return true;
+}
+
+bool Uringer::Recv(int fd, uint64_t data) {
+    struct io_uring_sqe* sqe = GetSqe_();
+    if (!sqe) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->len = bufSize_;
+    sqe->flags = IOSQE_BUFFER_SELECT; // 由内核在数据到达时从 buffer ring 中挑选缓冲区
+    sqe->buf_group = BUF_GROUP;
+    sqe->user_data = data;
+    return true;
+}
+
+bool Uringer::Read(int fd, void* buf, size_t len, uint64_t data) {
+    struct io_uring_sqe* sqe = GetSqe_();
+    if (!sqe) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(buf);
+    sqe->len = static_cast<unsigned>(len);
+    sqe->off = static_cast<uint64_t>(-1); // 使用/推进文件当前位置（对 eventfd 无意义）
+    sqe->user_data = data;
+    return true;
+}
+
+bool Uringer::Writev(int fd, const struct iovec* iov, int iovCnt, uint64_t data) {
+    struct io_uring_sqe* sqe = GetSqe_();
+    if (!sqe) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_WRITEV;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(iov);
+    sqe->len = static_cast<unsigned>(iovCnt);
+    sqe->off = static_cast<uint64_t>(-1);
+    sqe->user_data = data;
+    return true;
+}
+
+bool Uringer::Close(int fd, uint64_t data) {
+    struct io_uring_sqe* sqe = GetSqe_();
+    if (!sqe) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->fd = fd;
+    sqe->user_data = data;
+    return true;
+}
+
+// 被取消的请求以 -ECANCELED 完成，取消操作本身另有一个完成事件（user_data 为 data）
+bool Uringer::Cancel(uint64_t target, uint64_t data) {
+    struct io_uring_sqe* sqe = GetSqe_();
+    if (!sqe) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = target;
+    sqe->user_data = data;
+    return true;
+}
+
+// 消费上一批完成事件，提交新请求并等待；一次 io_uring_enter 同时完成“提交 + 等待”
+int Uringer::Wait(int timeoutMs) {
+    if (cqReady_) {
+        __atomic_store_n(cqHead_, *cqHead_ + cqReady_, __ATOMIC_RELEASE);
+        cqReady_ = 0;
+    }
+    unsigned toSubmit = sqLocalTail_ - *sqTail_;
+    __atomic_store_n(sqTail_, sqLocalTail_, __ATOMIC_RELEASE);
+
+    unsigned ready = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE) - *cqHead_;
+    if (ready == 0 || toSubmit > 0) {
+        // 已有完成事件时只提交不等待
+        int ret = Enter_(toSubmit, ready == 0 ? 1 : 0, timeoutMs);
+        if (ret < 0 && errno != ETIME && errno != EINTR) {
+            return -1;
+        }
+        ready = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE) - *cqHead_;
+    }
+    cqReady_ = ready;
+    return static_cast<int>(ready);
+}
+
+const struct io_uring_cqe* Uringer::Cqe_(size_t i) const {
+    assert(i < cqReady_);
+    return &cqes_[(*cqHead_ + i) & *cqMask_];
+}
+
+uint64_t Uringer::GetData(size_t i) const {
+    return Cqe_(i)->user_data;
+}
+
+int Uringer::GetRes(size_t i) const {
+    return Cqe_(i)->res;
+}
+
+const char* Uringer::GetBuffer(size_t i) const {
+    const struct io_uring_cqe* cqe = Cqe_(i);
+    if (!(cqe->flags & IORING_CQE_F_BUFFER)) {
+        return nullptr;
+    }
+    unsigned bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+    return bufs_ + static_cast<size_t>(bid) * bufSize_;
+}
+
+// 把缓冲区放回 buffer ring 尾部（本线程是唯一生产者，只需 release 语义发布新尾指针）
+void Uringer::RecycleBuffer(size_t i) {
+    const struct io_uring_cqe* cqe = Cqe_(i);
+    if (!(cqe->flags & IORING_CQE_F_BUFFER)) {
+        return;
+    }
+    unsigned short bid = static_cast<unsigned short>(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+    unsigned short tail = bufRing_->tail; // tail 与第 0 项的 resv 重叠，偏移 14
+    struct io_uring_buf* buf = reinterpret_cast<struct io_uring_buf*>(bufRing_) + (tail & (bufCount_ - 1));
+    buf->addr = reinterpret_cast<uint64_t>(bufs_ + static_cast<size_t>(bid) * bufSize_);
+    buf->len = bufSize_;
+    buf->bid = bid;
+    __atomic_store_n(&bufRing_->tail, static_cast<unsigned short>(tail + 1), __ATOMIC_RELEASE);
+}
+
+#else // !HAVE_IO_URING：内核头文件太旧，所有操作失败，调用方回退 epoll
+
+Uringer::Uringer(unsigned, unsigned, unsigned) {}
+Uringer::~Uringer() {}
+bool Uringer::IsOpen() const {
+    return false;
+}
+bool Uringer::Accept(int, sockaddr*, socklen_t*, uint64_t) {
+    return false;
+}
+bool Uringer::Recv(int, uint64_t) {
+    return false;
+}
+bool Uringer::Read(int, void*, size_t, uint64_t) {
+    return false;
+}
+bool Uringer::Writev(int, const struct iovec*, int, uint64_t) {
+    return false;
+}
+bool Uringer::Close(int, uint64_t) {
+    return false;
+}
+bool Uringer::Cancel(uint64_t, uint64_t) {
+    return false;
+}
+int Uringer::Wait(int) {
+    return -1;
+}
+uint64_t Uringer::GetData(size_t) const {
+    return 0;
+}
+int Uringer::GetRes(size_t) const {
+    return -ENOSYS;
+}
+const char* Uringer::GetBuffer(size_t) const {
+    return nullptr;
+}
+void Uringer::RecycleBuffer(size_t) {}
+
+#endif // HAVE_IO_URING
@@ -0,0 +1,81 @@
+#ifndef URINGER_H
+#define URINGER_H
+
+#include <sys/socket.h>    // sockaddr / socklen_t
+#include <sys/uio.h>       // iovec
+#include <linux/version.h> // LINUX_VERSION_CODE，判断内核头文件是否支持 provided buffer ring
+#include <stdint.h>        // uint64_t 等
+#include <stddef.h>        // size_t
+
+// 内核头文件 >= 5.19 才有 IORING_REGISTER_PBUF_RING；更老的系统上 Uringer 始终打开失败，服务器回退到 epoll
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 19, 0)
+#define HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#endif
+
+// io_uring 的最小封装（不依赖 liburing，直接走 io_uring_setup / io_uring_enter / io_uring_register 系统调用）
+// 用法与 Epoller 对应：先 Accept/Recv/Writev/... 填入提交队列，再 Wait() 一次系统调用完成提交 + 等待，
+// 然后用 GetData(i)/GetRes(i) 遍历完成事件；完成事件在下一次 Wait() 前有效。
+// Recv 使用 provided buffer ring：内核在数据到达时才从环中取缓冲区，空闲连接不占用读缓冲。
+class Uringer {
+public:
+    explicit Uringer(unsigned entries = 1024, unsigned bufCount = 512, unsigned bufSize = 4096);
+    ~Uringer();
+
+    bool IsOpen() const; // io_uring 是否初始化成功（失败时调用方应回退 epoll）
+
+    bool Accept(int fd, sockaddr* addr, socklen_t* len, uint64_t data);      // 提交 accept
+    bool Recv(int fd, uint64_t data);                                         // 提交 recv（从 buffer ring 选缓冲区）
+    bool Read(int fd, void* buf, size_t len, uint64_t data);                  // 提交普通 read（用于 eventfd）
+    bool Writev(int fd, const struct iovec* iov, int iovCnt, uint64_t data); // 提交 writev
+    bool Close(int fd, uint64_t data);                                        // 提交 close
+    bool Cancel(uint64_t target, uint64_t data);                              // 取消 user_data 为 target 的在途请求
+
+    int Wait(int timeoutMs = -1); // 提交所有待提交请求并等待至少一个完成事件，返回可处理的完成事件数
+
+    uint64_t GetData(size_t i) const; // 第 i 个完成事件的用户数据
+    int GetRes(size_t i) const;       // 第 i 个完成事件的结果（>= 0 成功，< 0 为 -errno）
+
+    const char* GetBuffer(size_t i) const; // Recv 完成事件所用的缓冲区（无则 nullptr）
+    void RecycleBuffer(size_t i);          // 把第 i 个完成事件的缓冲区还给 buffer ring
+
+private:
+#ifdef HAVE_IO_URING
+    struct io_uring_sqe* GetSqe_(); // 取一个空闲 SQE（提交队列满时先提交一次）
+    int Enter_(unsigned toSubmit, unsigned minComplete, int timeoutMs);
+    const struct io_uring_cqe* Cqe_(size_t i) const;
+
+    int ringFd_; // io_uring 实例 fd
+
+    // 提交队列（SQ）
+    unsigned* sqHead_;
+    unsigned* sqTail_;
+    unsigned* sqMask_;
+    unsigned* sqArray_;
+    struct io_uring_sqe* sqes_;
+    unsigned sqLocalTail_; // 已填写但尚未对内核发布的尾指针
+
+    // 完成队列（CQ）
+    unsigned* cqHead_;
+    unsigned* cqTail_;
+    unsigned* cqMask_;
+    struct io_uring_cqe* cqes_;
+    unsigned cqReady_; // 上一次 Wait() 返回的完成事件数，下一次 Wait() 时统一消费
+
+    // 映射的内存区域，析构时 munmap
+    void* sqRing_;
+    size_t sqRingSize_;
+    void* cqRing_;
+    size_t cqRingSize_;
+    size_t sqesSize_;
+
+    // provided buffer ring
+    struct io_uring_buf_ring* bufRing_;
+    size_t bufRingSize_;
+    char* bufs_;
+    unsigned bufCount_;
+    unsigned bufSize_;
+#endif
+};
+
+#endif // URINGER_H
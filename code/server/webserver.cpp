@@ -1,24 +1,149 @@
 #include "webserver.h"
 
+// 过载时回复的 503，预先生成，拒绝一个连接只需一次 send
+static const char BUSY_RESPONSE[] = "HTTP/1.1 503 Service Unavailable\r\n"
+                                    "Content-Type: text/plain\r\n"
+                                    "Content-Length: 12\r\n"
+                                    "Retry-After: 1\r\n"
+                                    "Connection: close\r\n"
+                                    "\r\n"
+                                    "Server busy!";
+
+// 按 IP 限流拒绝时回复的 429
+static const char LIMIT_RESPONSE[] = "HTTP/1.1 429 Too Many Requests\r\n"
+                                     "Content-Type: text/plain\r\n"
+                                     "Content-Length: 18\r\n"
+                                     "Retry-After: 1\r\n"
+                                     "Connection: close\r\n"
+                                     "\r\n"
+                                     "Too many requests!";
+
+// 按 IP 限流的键（IPv4 地址）；Unix 域连接来自本机代理，不参与限流
+static bool LimitKey(const sockaddr_storage& addr, uint32_t* key) {
+    if (addr.ss_family != AF_INET) {
+        return false;
+    }
+    *key = reinterpret_cast<const sockaddr_in&>(addr).sin_addr.s_addr;
+    return true;
+}
+
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69 // Linux 5.11，旧内核头文件中没有
+#endif
+
 // 构造函数：初始化服务器配置与各个子模块（定时器、线程池、epoller、MySQL连接池等）
 WebServer::WebServer(int port, int trigMode, int timeoutMS, bool OptLinger, int sqlPort, const char* sqlUser,
                      const char* sqlPwd, const char* dbName, int connPoolNum, int threadNum, bool openLog, int logLevel,
-                     int logQueSize)
-    : port_(port), openLinger_(OptLinger), timeoutMS_(timeoutMS), isClose_(false), timer_(new HeapTimer()),
-      threadpool_(new ThreadPool(threadNum)), epoller_(new Epoller()) {
+                     int logQueSize, const ServerOptions& opts)
+    : port_(port), openLinger_(OptLinger), timeoutMS_(timeoutMS), isClose_(false), listenFd_(-1), unixFd_(-1),
+      unixOwner_(false), opts_(opts), nextLoop_(1), ownStats_(),
+      stats_(opts.sharedStats ? *opts.sharedStats : ownStats_), busyPollWarned_(false), overloaded_(false),
+      tcpStartOk_(false), draining_(false), drainDeadlineNs_(0), handoffFd_(-1), handoffConn_(-1), handedOff_(false) {
     // 获取当前工作目录（返回动态分配内存，需要 later free）
     srcDir_ = getcwd(nullptr, 256);
     assert(srcDir_);
     // 将资源目录拼接到当前工作目录后面（确保目录尾部空间够用）
     strncat(srcDir_, "/resources/", 16);
 
-    // 初始化 HttpConn 的静态成员：在线用户数和资源目录
+    // 初始化 HttpConn 的静态成员：在线用户数、资源目录和流水线深度
     HttpConn::userCount = 0;
     HttpConn::srcDir = srcDir_;
+    HttpConn::pipelineDepth = std::min(std::max(opts_.pipelineDepth, 1), static_cast<int>(HttpConn::MAX_PIPELINE));
+
+    // 请求体：内存中收齐的上限决定一次读事件最多读多少（一个完整的头部加内存中的请求体），转存时读缓冲区不超过这个量
+    HttpRequest::maxBodySize = opts_.maxBodySize;
+    HttpRequest::bodyMemLimit = std::min(opts_.bodyMemLimit, opts_.maxBodySize);
+    HttpRequest::bodyTempDir = opts_.bodyTempDir;
+    HttpRequest::bodyHandler = opts_.bodyHandler;
+    HttpRequest::partHandler = opts_.partHandler;
+    HttpConn::requestHandler = opts_.requestHandler;
+    HttpConn::router = HttpRouter(); // 路由表只在这里建立，之后只读
+    HttpConn::AddSiteRoutes(HttpConn::router);
+    if (opts_.routes) {
+        opts_.routes(HttpConn::router);
+    }
+    HttpConn::readHighWater = std::max(HttpRequest::bodyMemLimit, HttpRequest::BODY_CHUNK) + HttpParser::MAX_HEAD_SIZE;
 
     // 初始化 MySQL 连接池（连接到本地主机，端口 sqlPort）
+    // Prefork 工作进程：connPoolNum 是所有进程合计的连接数，每个进程分得其中一份，数据库侧的连接总数不随进程数放大
+    if (opts_.workerIndex >= 0 && opts_.workerProcesses > 0) {
+        connPoolNum = std::max(1, (connPoolNum + opts_.workerProcesses - 1) / opts_.workerProcesses);
+    }
     SqlConnPool::Instance()->Init("localhost", sqlPort, sqlUser, sqlPwd, dbName, connPoolNum);
 
+    // 解析绑核配置（格式错误时忽略，稍后在日志中提示）
+    bool reactorCpusOk = opts_.reactorCpus.empty() || CpuAffinity::Parse(opts_.reactorCpus, &reactorCpus_);
+    bool workerCpusOk = opts_.workerCpus.empty() || CpuAffinity::Parse(opts_.workerCpus, &workerCpus_);
+
+    if (opts_.maxConnPerIp > 0 || opts_.ipRate > 0) {
+        limiter_.reset(new ClientLimiter(opts_.maxConnPerIp, opts_.ipRate, opts_.ipBurst));
+    }
+
+    // 创建事件循环：单 Reactor 只有主线程一个循环，读写交给线程池；多 Reactor 每个循环独立完成读写
+    // 主从 Reactor 额外多一个只做 accept 的主 Reactor（0 号）
+    int loopNum = opts_.reactorNum > 0 ? opts_.reactorNum : 1;
+    if (opts_.reactorNum > 0 && opts_.mainSubReactor) {
+        loopNum++;
+    }
+    bool useUring = opts_.ioUring;
+    for (int i = 0; i < loopNum; i++) {
+        std::unique_ptr<EventLoop> loop(new EventLoop);
+        loop->id = i;
+        loop->listenFd = -1;
+        loop->unixFd = -1;
+        loop->connCount = 0;
+        loop->acceptPaused = false;
+        loop->acceptRetryNs[0] = loop->acceptRetryNs[1] = 0;
+        loop->draining = false;
+        loop->timer.reset(new HeapTimer());
+        loop->users.reset(new ConnSlab(MAX_FD));
+        loop->reqStart.assign(MAX_FD, 0);
+        loop->inflight.assign(MAX_FD, INFLIGHT_IDLE);
+        if (useUring) {
+            loop->uring.reset(new Uringer());
+            if (!loop->uring->IsOpen()) {
+                // 内核不支持 io_uring：所有循环统一回退到 epoll
+                useUring = false;
+                for (auto& prev : loops_) {
+                    prev->uring.reset();
+                }
+                loop->uring.reset();
+            }
+        }
+        loops_.push_back(std::move(loop));
+    }
+    for (auto& loop : loops_) {
+        if (loop->uring) {
+            // io_uring 对阻塞 fd 会自动等待就绪，eventfd 不设 O_NONBLOCK（否则 read 立即返回 EAGAIN）
+            loop->wakeupFd = eventfd(0, EFD_CLOEXEC);
+        } else {
+            loop->wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            loop->epoller.reset(new Epoller());
+            loop->epoller->AddFd(loop->wakeupFd, EPOLLIN);
+        }
+        assert(loop->wakeupFd >= 0);
+    }
+    // io_uring 下请求在循环线程内处理，同多 Reactor 一样不需要线程池
+    if (opts_.reactorNum <= 0 && !useUring) {
+        if (opts_.dispatch == DISPATCH_AFFINITY) {
+            // 连接亲和：每个工作线程独占一个任务队列，同一连接的任务总在同一线程上串行执行
+            for (int i = 0; i < threadNum; i++) {
+                std::vector<int> cpu;
+                if (!workerCpus_.empty()) {
+                    cpu.push_back(workerCpus_[i % workerCpus_.size()]);
+                }
+                workers_.emplace_back(new ThreadPool(1, cpu));
+            }
+        } else {
+            threadpool_.reset(new ThreadPool(threadNum, workerCpus_));
+        }
+        if (opts_.dispatch == DISPATCH_PROACTOR) {
+            loops_[0]->doneNodes.resize(MAX_FD);
+        }
+    }
+    // 对端关闭后继续 writev 会触发 SIGPIPE，默认行为是终止进程
+    signal(SIGPIPE, SIG_IGN);
+
     // 根据传入的 trigMode 设置 epoll 触发模式（ET/LT）等
     InitEventMode_(trigMode);
 
@@ -26,28 +151,137 @@ WebServer::WebServer(int port, int trigMode, int timeoutMS, bool OptLinger, int
     if (!InitSocket_()) {
         isClose_ = true;
     }
+    tcpStartOk_ = tcpStart_.Read();
 
     // 初始化日志系统（如果需要）
     if (openLog) {
-        Log::Instance()->init(logLevel, "./log", ".log", logQueSize);
+        // Prefork 工作进程各写各的文件（./log/日期.w编号.log），行数计数和按行分文件互不干扰
+        // Log 只保存后缀指针，用静态字符串保证进程内一直有效
+        static std::string logSuffix;
+        logSuffix = opts_.workerIndex >= 0 ? ".w" + std::to_string(opts_.workerIndex) + ".log" : ".log";
+        Log::Instance()->init(logLevel, "./log", logSuffix.c_str(), logQueSize);
+        if (opts_.logCpu >= 0 && !Log::Instance()->PinWriteThread(opts_.logCpu)) {
+            LOG_WARN("Pin log thread to cpu %d failed", opts_.logCpu);
+        }
         if (isClose_) {
             LOG_ERROR("========== Server init error!==========");
         } else {
             LOG_INFO("========== Server init ==========");
             LOG_INFO("Port:%d, OpenLinger: %s", port_, OptLinger ? "true" : "false");
+            if (opts_.workerIndex >= 0) {
+                LOG_INFO("Prefork worker %d/%d, pid: %d", opts_.workerIndex, opts_.workerProcesses, (int)getpid());
+            }
             LOG_INFO("Listen Mode: %s, OpenConn Mode: %s", (listenEvent_ & EPOLLET ? "ET" : "LT"),
                      (connEvent_ & EPOLLET ? "ET" : "LT"));
+            LOG_INFO("IO backend: %s%s", useUring ? "io_uring" : "epoll",
+                     opts_.ioUring && !useUring ? " (io_uring unavailable, fallback)" : "");
             LOG_INFO("LogSys level: %d", logLevel);
             LOG_INFO("srcDir: %s", HttpConn::srcDir);
-            LOG_INFO("SqlConnPool num: %d, ThreadPool num: %d", connPoolNum, threadNum);
+            LOG_INFO("HTTP header scan: %s", HttpScan::LevelName(HttpScan::Level()));
+            LOG_INFO("SqlConnPool num: %d, ThreadPool num: %d, Dispatch: %s", connPoolNum,
+                     threadpool_ || !workers_.empty() ? threadNum : 0, !workers_.empty() ? "affinity" : opts_.dispatch == DISPATCH_PROACTOR ? "proactor" : "pool");
+            if (!reactorCpusOk || !workerCpusOk) {
+                LOG_WARN("Invalid cpu list ignored, reactorCpus: \"%s\", workerCpus: \"%s\"", opts_.reactorCpus.c_str(),
+                         opts_.workerCpus.c_str());
+            }
+            if (!reactorCpus_.empty() || !workerCpus_.empty() || opts_.logCpu >= 0) {
+                LOG_INFO("CPU affinity, reactors: [%s], workers: [%s], log: %d",
+                         CpuAffinity::ToString(reactorCpus_).c_str(), CpuAffinity::ToString(workerCpus_).c_str(),
+                         opts_.logCpu);
+            }
+            if ((threadpool_ || !workers_.empty()) && (opts_.queueHighWater > 0 || opts_.queueDelayHighUs > 0)) {
+                LOG_INFO("Admission control, queue water: %d/%d, queue delay: %d us, shed: %s", opts_.queueHighWater,
+                         opts_.queueLowWater, opts_.queueDelayHighUs, opts_.shedMode == SHED_503 ? "503" : "pause accept");
+            }
+            LOG_INFO("Socket backlog: %d, defer accept: %d s, fast open queue: %d, nodelay: %s, cork: %s",
+                     opts_.listenBacklog, opts_.deferAcceptSec, opts_.fastOpenQueue, opts_.tcpNoDelay ? "on" : "off",
+                     opts_.tcpCork ? "on" : "off");
+            if (limiter_) {
+                LOG_INFO("Per-IP limit, max conn: %d, rate: %.1f/s, burst: %.1f", opts_.maxConnPerIp, opts_.ipRate,
+                         opts_.ipBurst > 0 ? opts_.ipBurst : opts_.ipRate);
+            }
+            if (opts_.busyPollUs > 0) {
+                LOG_INFO("Busy poll: %d us%s", opts_.busyPollUs, useUring ? " (not used by io_uring)" : "");
+            }
+            if ((threadpool_ || !workers_.empty()) && opts_.inlineThreshold > 0) {
+                LOG_INFO("Adaptive inline threshold: %zu bytes", opts_.inlineThreshold);
+            }
+            if (opts_.reactorNum > 0 && opts_.mainSubReactor) {
+                LOG_INFO("Main-Sub Reactor, sub num: %d, dispatch: %s", opts_.reactorNum,
+                         opts_.leastLoaded ? "least-loaded" : "round-robin");
+            } else if (opts_.reactorNum > 0) {
+                LOG_INFO("Reactor num: %d, Listen: %s", opts_.reactorNum,
+                         opts_.sharedListen ? "shared + EPOLLEXCLUSIVE" : "SO_REUSEPORT");
+            }
         }
     }
 }
 
 // 析构：关闭监听 fd，标记关闭，释放 srcDir 内存，并关闭数据库连接池
 WebServer::~WebServer() {
-    close(listenFd_);
     isClose_ = true;
+    if (handoffThread_.joinable()) {
+        handoffThread_.join();
+    }
+    for (auto& loop : loops_) {
+        WakeUp_(loop.get()); // 让阻塞在 epoll_wait 的循环线程尽快看到 isClose_
+        if (loop->thread.joinable()) {
+            loop->thread.join();
+        }
+    }
+    // 工作线程中可能还有引用连接和事件循环的任务：等它们执行完（ThreadPool 析构会 join）再释放 fd 和事件循环
+    threadpool_.reset();
+    workers_.clear();
+    for (auto& loop : loops_) {
+        close(loop->wakeupFd);
+    }
+    for (int fd : ListenFds_()) {
+        close(fd);
+    }
+    // 监听 socket 已交给新进程时，socket 文件属于新进程，不能删除
+    if (unixFd_ >= 0 && unixOwner_ && !handedOff_) {
+        unlink(opts_.unixPath.c_str());
+    }
+    if (handoffConn_ >= 0) {
+        close(handoffConn_); // 初始化失败、未确认接管：旧进程看到连接关闭后继续服务
+    }
+    if (handoffFd_ >= 0) {
+        close(handoffFd_);
+        if (!handedOff_) {
+            unlink(opts_.handoffPath.c_str());
+        }
+    }
+    LOG_INFO("Requests: %llu, latency(us) p50: %llu, p99: %llu, p999: %llu",
+             (unsigned long long)stats_.requests.load(), (unsigned long long)stats_.latency.Percentile(0.5),
+             (unsigned long long)stats_.latency.Percentile(0.99), (unsigned long long)stats_.latency.Percentile(0.999));
+    LOG_INFO("Read events inlined: %llu, offloaded: %llu", (unsigned long long)stats_.inlined.load(),
+             (unsigned long long)stats_.offloaded.load());
+    if (opts_.queueHighWater > 0 || opts_.queueDelayHighUs > 0) {
+        LOG_INFO("Overloads: %llu, shed: %llu, accept pauses: %llu", (unsigned long long)stats_.overloads.load(),
+                 (unsigned long long)stats_.shed.load(), (unsigned long long)stats_.pauses.load());
+    }
+    LOG_INFO("Accepts: %llu, accept wakeups: %llu, corked responses: %llu", (unsigned long long)stats_.accepts.load(),
+             (unsigned long long)stats_.acceptWakeups.load(), (unsigned long long)stats_.corked.load());
+    TcpCounters tcpNow;
+    if (tcpStartOk_ && tcpNow.Read()) {
+        // 整个网络命名空间的计数器差值，机器上有其他 TCP 服务时只能作参考
+        TcpCounters d = tcpNow.Since(tcpStart_);
+        LOG_INFO("Kernel TCP delta, passive opens: %llu, listen overflows: %llu, listen drops: %llu, "
+                 "fast open: %llu (fail %llu, overflow %llu), out segs: %llu, retrans: %llu",
+                 (unsigned long long)d.passiveOpens, (unsigned long long)d.listenOverflows,
+                 (unsigned long long)d.listenDrops, (unsigned long long)d.fastOpenPassive,
+                 (unsigned long long)d.fastOpenFail, (unsigned long long)d.fastOpenOverflow,
+                 (unsigned long long)d.outSegs, (unsigned long long)d.retransSegs);
+    }
+    if (limiter_) {
+        LOG_INFO("Per-IP rejects, conn limit: %llu, rate limit: %llu, tracked ips: %zu",
+                 (unsigned long long)stats_.ipConnRejects.load(), (unsigned long long)stats_.ipRateRejects.load(),
+                 limiter_->Size());
+    }
+    if (opts_.busyPollUs > 0) {
+        LOG_INFO("Busy poll spin: %llu ms, hits: %llu, misses: %llu", (unsigned long long)stats_.spinNs.load() / 1000000,
+                 (unsigned long long)stats_.spinHits.load(), (unsigned long long)stats_.spinMisses.load());
+    }
     free(srcDir_);
     SqlConnPool::Instance()->ClosePool();
 }
@@ -81,42 +315,213 @@ void WebServer::InitEventMode_(int trigMode) {
     HttpConn::isET = (connEvent_ & EPOLLET);
 }
 
-// 主循环：等待 epoll 事件并分发处理
+// 启动服务器：多 Reactor 时 1..N-1 号循环各起一个线程，0 号循环运行在主线程
 void WebServer::Start() {
-    int timeMS = -1; /* epoll wait timeout == -1 无事件将阻塞 */
     if (!isClose_) {
         LOG_INFO("========== Server start ==========");
+        // 先占用控制 socket，再确认接管：旧进程收到确认时，下一次重启已经能连到本进程
+        if (!opts_.handoffPath.empty()) {
+            handoffFd_ = ListenHandoff::Listen(opts_.handoffPath);
+            if (handoffFd_ < 0) {
+                LOG_ERROR("Handoff socket %s error!", opts_.handoffPath.c_str());
+            } else {
+                handoffThread_ = std::thread(&WebServer::HandoffLoop_, this);
+            }
+        }
+        if (handoffConn_ >= 0) {
+            ListenHandoff::Ack(handoffConn_);
+            handoffConn_ = -1;
+            LOG_INFO("Took over listen sockets from previous process");
+        }
+    }
+    for (size_t i = 1; i < loops_.size() && !isClose_; i++) {
+        loops_[i]->thread = std::thread(&WebServer::RunLoop_, this, loops_[i].get());
+    }
+    RunLoop_(loops_[0].get());
+    // 排空结束：等其余循环也退出后再返回
+    for (size_t i = 1; i < loops_.size(); i++) {
+        if (loops_[i]->thread.joinable()) {
+            loops_[i]->thread.join();
+        }
+    }
+}
+
+void WebServer::Drain() {
+    if (draining_) {
+        return;
+    }
+    drainDeadlineNs_ = ServerStats::NowNs() + static_cast<int64_t>(opts_.drainTimeoutMs) * 1000000;
+    draining_ = true;
+    for (auto& loop : loops_) {
+        WakeUp_(loop.get());
+    }
+}
+
+// 每轮事件循环开始时检查排空状态；排空中把等待时间限制在 DRAIN_TICK_MS 内，以便按时检查期限
+bool WebServer::Drained_(EventLoop* loop, int* timeMS) {
+    static const int DRAIN_TICK_MS = 100;
+    if (!draining_) {
+        return false;
+    }
+    if (!loop->draining) {
+        BeginDrain_(loop);
+    }
+    if (loop->connCount <= 0) {
+        return true;
+    }
+    if (ServerStats::NowNs() >= drainDeadlineNs_) {
+        LOG_WARN("Drain timeout, loop %d drops %d connections", loop->id, (int)loop->connCount);
+        return true;
+    }
+    if (*timeMS < 0 || *timeMS > DRAIN_TICK_MS) {
+        *timeMS = DRAIN_TICK_MS;
     }
+    return false;
+}
+
+// 停止 accept（epoll 移出监听 socket，io_uring 取消在途 accept），关闭空闲连接；
+// 其余连接写完当前响应后不再保持长连接（见 OnWrite_ 等处的 draining_ 判断）。
+// 只有连接完全由本循环线程处理（io_uring、Proactor、没有线程池的多 Reactor）时才就地关闭：线程池 / 连接亲和模式下
+// 工作线程在 EndRequest_ 之后还会继续使用连接（process、重新挂载 epoll），本线程无法判断连接是否在工作线程中，
+// 这些连接只是不再保持长连接，空闲的由超时定时器或排空期限回收
+void WebServer::BeginDrain_(EventLoop* loop) {
+    loop->draining = true;
+    int listenFds[2] = {loop->listenFd, loop->unixFd};
+    for (int k = 0; k < 2; k++) {
+        if (listenFds[k] < 0) {
+            continue;
+        }
+        if (loop->uring) {
+            loop->uring->Cancel((uint64_t)URING_ACCEPT << 32 | (uint32_t)listenFds[k], (uint64_t)URING_CANCEL << 32);
+            loop->acceptRetryNs[k] = 0; // 等待重试的不再投递
+        } else if (!loop->acceptPaused) {
+            loop->epoller->DelFd(listenFds[k]);
+        }
+    }
+    loop->acceptPaused = false;
+    int idle = 0;
+    bool loopOwned = loop->uring || !loop->doneNodes.empty() || (!threadpool_ && workers_.empty());
+    for (size_t fd = 0; loopOwned && fd < loop->users->Capacity(); fd++) {
+        if (!loop->users->Online(fd)) {
+            continue;
+        }
+        HttpConn* client = loop->users->At(fd);
+        // 有进行中的请求、正在工作线程中计算（Proactor）、读缓冲区中还有没处理的数据（流水线中后面的请求、不完整的请求），
+        // 或已有数据到达还没读到（刚 accept 的连接、请求已发出）的都不算空闲，留给正常流程处理。
+        // io_uring 的空闲连接总有一个在途 recv，CloseConn_ 会先 shutdown 再等它完成
+        char c;
+        if (loop->reqStart[fd] == 0 && (loop->uring || loop->inflight[fd] == INFLIGHT_IDLE) &&
+            client->ReadBufferedBytes() == 0 && client->ToWriteBytes() == 0 &&
+            recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) <= 0) {
+            CloseConn_(loop, client);
+            idle++;
+        }
+    }
+    LOG_INFO("Loop %d draining, closed %d idle connections, %d remaining", loop->id, idle, (int)loop->connCount);
+}
+
+// 控制 socket 线程：等待新进程连接，交出监听 socket；新进程确认接管后本进程开始排空
+void WebServer::HandoffLoop_() {
+    static const int HANDOFF_ACK_MS = 30000; // 新进程从收到 fd 到完成初始化的最长等待
+    while (!isClose_ && !draining_) {
+        struct pollfd pfd = {handoffFd_, POLLIN, 0};
+        if (poll(&pfd, 1, 200) <= 0) {
+            continue; // 定期检查 isClose_
+        }
+        int conn = accept4(handoffFd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (conn < 0) {
+            continue;
+        }
+        if (!ListenHandoff::PeerAllowed(conn)) {
+            LOG_WARN("Handoff request from another user rejected");
+            close(conn);
+            continue;
+        }
+        std::vector<int> fds = ListenFds_();
+        LOG_INFO("Handoff requested, passing %zu listen sockets", fds.size());
+        bool ok = ListenHandoff::Serve(conn, fds, HANDOFF_ACK_MS);
+        close(conn);
+        if (ok) {
+            handedOff_ = true;
+            LOG_INFO("Handoff confirmed, draining");
+            Drain();
+            return;
+        }
+        LOG_WARN("Handoff not confirmed, keep serving");
+    }
+}
+
+std::vector<int> WebServer::ListenFds_() const {
+    std::vector<int> fds;
+    for (auto& loop : loops_) {
+        int listenFds[2] = {loop->listenFd, loop->unixFd};
+        for (int fd : listenFds) {
+            if (fd >= 0 && std::find(fds.begin(), fds.end(), fd) == fds.end()) {
+                fds.push_back(fd);
+            }
+        }
+    }
+    return fds;
+}
+
+// 主循环：等待 epoll 事件并分发处理（每个 EventLoop 一份，只访问自己的 epoller/timer/users）
+void WebServer::RunLoop_(EventLoop* loop) {
+    PlaceLoop_(loop);
+    if (loop->uring) {
+        RunUringLoop_(loop);
+        return;
+    }
+    int timeMS = -1; /* epoll wait timeout == -1 无事件将阻塞 */
     while (!isClose_) {
         // 若启用超时检测，则获取下一次最近的定时器触发时间，传给 epoll_wait 作为超时
         if (timeoutMS_ > 0) {
-            timeMS = timer_->GetNextTick();
+            timeMS = loop->timer->GetNextTick();
+        }
+        // 暂停 accept 期间没有监听事件驱动，定期检查过载是否解除
+        if (loop->acceptPaused) {
+            ResumeAccept_(loop);
+            if (loop->acceptPaused && (timeMS < 0 || timeMS > 10)) {
+                timeMS = 10;
+            }
+        }
+        if (Drained_(loop, &timeMS)) {
+            break;
         }
-        // 等待事件发生，最多等待 timeMS 毫秒（-1 表示阻塞）
-        int eventCnt = epoller_->Wait(timeMS);
+        // 等待事件发生，最多等待 timeMS 毫秒（-1 表示阻塞）；开启忙轮询时先自旋
+        int eventCnt = opts_.busyPollUs > 0 ? BusyWait_(loop, timeMS) : loop->epoller->Wait(timeMS);
         for (int i = 0; i < eventCnt; i++) {
             /* 处理每个就绪事件 */
-            int fd = epoller_->GetEventFd(i);
-            uint32_t events = epoller_->GetEvents(i);
+            uint64_t data = loop->epoller->GetEventData(i);
+            int fd = static_cast<int>(data & 0xffffffff);
+            uint32_t events = loop->epoller->GetEvents(i);
 
-            // 如果是监听 socket，就处理新的连接
-            if (fd == listenFd_) {
-                DealListen_();
+            // 如果是监听 socket（TCP 或 Unix 域），就处理新的连接
+            if (fd == loop->listenFd || fd == loop->unixFd) {
+                DealListen_(loop, fd);
+                continue;
+            }
+            // 被其他线程唤醒（主 Reactor 交来了新连接 / 服务器关闭）
+            if (fd == loop->wakeupFd) {
+                DealWakeup_(loop);
+                continue;
+            }
+            // 连接事件：data 为带代数的连接 id，查不到说明是已关闭连接的过期事件
+            HttpConn* client = loop->users->Get(data);
+            if (!client) {
+                LOG_DEBUG("Stale event on fd[%d]", fd);
+                continue;
             }
             // 处理异常 / 对端关闭 / 错误 等情况
-            else if (events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
-                assert(users_.count(fd) > 0);
-                CloseConn_(&users_[fd]);
+            if (events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                CloseConn_(loop, client);
             }
             // 可读事件
             else if (events & EPOLLIN) {
-                assert(users_.count(fd) > 0);
-                DealRead_(&users_[fd]);
+                DealRead_(loop, client);
             }
             // 可写事件
             else if (events & EPOLLOUT) {
-                assert(users_.count(fd) > 0);
-                DealWrite_(&users_[fd]);
+                DealWrite_(loop, client);
             } else {
                 LOG_ERROR("Unexpected event");
             }
@@ -124,6 +529,62 @@ void WebServer::Start() {
     }
 }
 
+// 绑核后再让连接槽优先从该 CPU 的 NUMA 节点分配；槽位在本线程首次使用时才分配物理页、构造 HttpConn，
+// HttpConn 的缓冲区也由本线程分配，按首次访问同样落在本地节点
+void WebServer::PlaceLoop_(EventLoop* loop) {
+    if (reactorCpus_.empty()) {
+        return;
+    }
+    int cpu = reactorCpus_[loop->id % reactorCpus_.size()];
+    if (!CpuAffinity::PinSelf(cpu)) {
+        LOG_WARN("Pin loop %d to cpu %d failed", loop->id, cpu);
+        return;
+    }
+    int node = CpuAffinity::NodeOf(cpu);
+    if (node >= 0 && loop->users->PreferNode(node)) {
+        LOG_INFO("Loop %d pinned to cpu %d, node %d", loop->id, cpu, node);
+    } else {
+        LOG_INFO("Loop %d pinned to cpu %d", loop->id, cpu);
+    }
+}
+
+// 忙轮询：在预算内（且不晚于下一个定时器）反复做非阻塞 epoll_wait，有事件立即返回；预算用完再阻塞剩余时间
+int WebServer::BusyWait_(EventLoop* loop, int timeMS) {
+    int64_t start = ServerStats::NowNs();
+    int64_t budget = opts_.busyPollUs * 1000LL;
+    if (timeMS >= 0 && timeMS * 1000000LL < budget) {
+        budget = timeMS * 1000000LL;
+    }
+    int64_t now;
+    int eventCnt;
+    do {
+        eventCnt = loop->epoller->Wait(0);
+        now = ServerStats::NowNs();
+    } while (eventCnt == 0 && now - start < budget && !isClose_);
+    stats_.spinNs.fetch_add(now - start, std::memory_order_relaxed);
+    if (eventCnt != 0) {
+        stats_.spinHits.fetch_add(1, std::memory_order_relaxed);
+        return eventCnt;
+    }
+    stats_.spinMisses.fetch_add(1, std::memory_order_relaxed);
+    if (timeMS > 0) {
+        timeMS = std::max<int64_t>(0, timeMS - (now - start) / 1000000);
+    }
+    return loop->epoller->Wait(timeMS);
+}
+
+// SO_BUSY_POLL：recv 在数据未到时先在驱动队列上忙等（超过 net.core.busy_read 需要 CAP_NET_ADMIN）；
+// SO_PREFER_BUSY_POLL：忙轮询期间抑制软中断，由应用线程收包。失败不影响连接，只告警一次
+void WebServer::SetBusyPoll_(int fd) {
+    int us = opts_.busyPollUs;
+    int one = 1;
+    if ((setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &us, sizeof(us)) < 0 ||
+         setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &one, sizeof(one)) < 0) &&
+        !busyPollWarned_.exchange(true)) {
+        LOG_WARN("set SO_BUSY_POLL/SO_PREFER_BUSY_POLL error: %s", strerror(errno));
+    }
+}
+
 // 发送错误信息并关闭 fd（用于拒绝连接等）
 void WebServer::SendError_(int fd, const char* info) {
     assert(fd > 0);
@@ -135,125 +596,858 @@ void WebServer::SendError_(int fd, const char* info) {
 }
 
 // 关闭并清理连接：从 epoll 删除并调用 HttpConn::Close()
-void WebServer::CloseConn_(HttpConn* client) {
+void WebServer::CloseConn_(EventLoop* loop, HttpConn* client) {
     assert(client);
+    if (loop->uring) {
+        if (client->IsClose()) {
+            return;
+        }
+        int fd = client->GetFd();
+        if (loop->inflight[fd] != INFLIGHT_IDLE) {
+            // recv/writev 仍在途：先 shutdown 让它尽快完成，完成事件到来时再关闭
+            loop->inflight[fd] = INFLIGHT_CLOSING;
+            shutdown(fd, SHUT_RDWR);
+            return;
+        }
+        LOG_INFO("Client[%d] quit!", fd);
+        loop->connCount--;
+        uint32_t key;
+        if (limiter_ && LimitKey(client->GetAddr(), &key)) {
+            limiter_->Disconnect(key);
+        }
+        loop->users->Release(fd);
+        client->Close(false);
+        loop->uring->Close(fd, (uint64_t)URING_CLOSE << 32 | (uint32_t)fd); // 异步关闭 fd
+        return;
+    }
+    if (loop->inflight[client->GetFd()] != INFLIGHT_IDLE) {
+        // Proactor：请求还在工作线程中处理，等它交回时再关闭
+        loop->inflight[client->GetFd()] = INFLIGHT_CLOSING;
+        return;
+    }
     LOG_INFO("Client[%d] quit!", client->GetFd());
-    epoller_->DelFd(client->GetFd());
+    loop->epoller->DelFd(client->GetFd());
+    if (!client->IsClose()) {
+        loop->connCount--;
+        uint32_t key;
+        if (limiter_ && LimitKey(client->GetAddr(), &key)) {
+            limiter_->Disconnect(key);
+        }
+    }
+    // 先让旧 id 失效再 close：fd 一旦关闭就可能被主线程 accept 复用，顺序反过来会把新连接的 id 也作废
+    loop->users->Release(client->GetFd());
     client->Close();
 }
 
-// 新连接加入：初始化 users_ 中的 HttpConn（placement by fd），加入定时器并注册 epoll
-void WebServer::AddClient_(int fd, sockaddr_in addr) {
+// 定时器回调只记录连接 id：连接已关闭或 fd 已被新连接复用时 id 过期，不会误关新连接
+void WebServer::OnTimeout_(EventLoop* loop, uint64_t id) {
+    HttpConn* client = loop->users->Get(id);
+    if (!client) {
+        LOG_DEBUG("Stale timer on fd[%d]", static_cast<int>(id & 0xffffffff));
+        return;
+    }
+    CloseConn_(loop, client);
+}
+
+// 新连接加入：启用本循环 users 中 fd 对应的槽位并初始化 HttpConn，加入定时器并注册 epoll
+void WebServer::AddClient_(EventLoop* loop, int fd, const sockaddr_storage& addr) {
     assert(fd > 0);
-    users_[fd].init(fd, addr); // 初始化 HttpConn 对象（构造在 unordered_map 中）
+    uint64_t id = loop->users->Open(fd);
+    HttpConn* client = loop->users->At(fd);
+    client->init(fd, addr); // 初始化 HttpConn 对象（槽位地址固定，可复用上一个连接的缓冲区）
+    loop->reqStart[fd] = 0;
+    loop->connCount++;
     if (timeoutMS_ > 0) {
-        // 为该 fd 添加超时定时器，回调为 CloseConn_（用于超时断开）
-        timer_->add(fd, timeoutMS_, std::bind(&WebServer::CloseConn_, this, &users_[fd]));
+        // 为该 fd 添加超时定时器，回调只带连接 id（用于超时断开）
+        loop->timer->add(fd, timeoutMS_, std::bind(&WebServer::OnTimeout_, this, loop, id));
+    }
+    if (loop->uring) {
+        // io_uring：直接投递 recv；socket 保持阻塞，由 io_uring 内部等待就绪
+        UringRecv_(loop, client);
+        LOG_INFO("Client[%d] in!", client->GetFd());
+        return;
+    }
+    if (opts_.busyPollUs > 0 && addr.ss_family != AF_UNIX) {
+        SetBusyPoll_(fd);
+    }
+    if (opts_.tcpNoDelay && addr.ss_family != AF_UNIX) {
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
     }
     // 注册到 epoll，初始只监听读事件 + connEvent_（例如 ONESHOT, EPOLLET）
-    epoller_->AddFd(fd, EPOLLIN | connEvent_);
+    loop->epoller->AddFd(fd, EPOLLIN | connEvent_, id);
     SetFdNonblock(fd); // 将客户端 socket 设为非阻塞
-    LOG_INFO("Client[%d] in!", users_[fd].GetFd());
+    LOG_INFO("Client[%d] in!", client->GetFd());
 }
 
 // 监听 socket 可读（即有新连接）时调用；如果是 ET 模式需要循环 accept
-void WebServer::DealListen_() {
-    struct sockaddr_in addr;
-    socklen_t len = sizeof(addr);
+void WebServer::DealListen_(EventLoop* loop, int listenFd) {
+    struct sockaddr_storage addr;
+    socklen_t len;
+    if (opts_.shedMode == SHED_PAUSE && Overloaded_()) {
+        // 暂停 accept：新连接留在内核 backlog 中，过载解除后再处理（TCP 和 Unix 域监听一起暂停）
+        if (loop->listenFd >= 0) {
+            loop->epoller->DelFd(loop->listenFd);
+        }
+        if (loop->unixFd >= 0) {
+            loop->epoller->DelFd(loop->unixFd);
+        }
+        loop->acceptPaused = true;
+        stats_.pauses++;
+        return;
+    }
+    stats_.acceptWakeups++;
     do {
-        int fd = accept(listenFd_, (struct sockaddr*)&addr, &len);
+        len = sizeof(addr); // 值-结果参数，每次 accept 前重置
+        int fd = accept(listenFd, (struct sockaddr*)&addr, &len);
         if (fd <= 0) {
             // accept 失败：可能没有新的连接（在非阻塞/ET下会返回 -1, errno==EAGAIN）
             return;
-        } else if (HttpConn::userCount >= MAX_FD) {
-            // 超过最大并发，发送错误并关闭
-            SendError_(fd, "Server busy!");
-            LOG_WARN("Clients is full!");
+        }
+        if (!AcceptConn_(loop, fd, addr)) {
             return;
         }
-        // 将新连接注册并初始化
-        AddClient_(fd, addr);
     } while (listenEvent_ & EPOLLET); // 如果监听 socket 为 ET，需要循环 accept 直到返回 EAGAIN
 }
 
-// 读事件分发：延长定时器并把读取任务交给线程池
-void WebServer::DealRead_(HttpConn* client) {
+// 接纳一个新连接：超过最大并发则拒绝（返回 false），主从 Reactor 交给从 Reactor，否则在本循环注册
+bool WebServer::AcceptConn_(EventLoop* loop, int fd, const sockaddr_storage& addr) {
+    stats_.accepts++;
+    if (HttpConn::userCount >= MAX_FD || fd >= MAX_FD) {
+        // 超过最大并发，发送错误并关闭
+        SendError_(fd, "Server busy!");
+        LOG_WARN("Clients is full!");
+        return false;
+    }
+    if (opts_.shedMode == SHED_503 && Overloaded_()) {
+        // 过载：回复 503 后立即关闭；返回 true 以便 ET 模式继续把 backlog 中的连接取完
+        send(fd, BUSY_RESPONSE, sizeof(BUSY_RESPONSE) - 1, MSG_DONTWAIT);
+        close(fd);
+        stats_.shed++;
+        return true;
+    }
+    uint32_t key;
+    if (limiter_ && LimitKey(addr, &key)) {
+        // 按 IP 限流：在交给从 Reactor / 初始化 HttpConn 之前拒绝，被拒绝的连接不占用连接槽
+        ClientLimiter::RESULT res = limiter_->Connect(key);
+        if (res != ClientLimiter::ALLOW) {
+            send(fd, LIMIT_RESPONSE, sizeof(LIMIT_RESPONSE) - 1, MSG_DONTWAIT);
+            close(fd);
+            if (res == ClientLimiter::DENY_CONN) {
+                stats_.ipConnRejects++;
+            } else {
+                stats_.ipRateRejects++;
+            }
+            return true;
+        }
+    }
+    // 主从 Reactor：交给从 Reactor 注册；否则在本循环注册并初始化
+    if (opts_.mainSubReactor && loops_.size() > 1) {
+        HandOff_(fd, addr);
+    } else {
+        AddClient_(loop, fd, addr);
+    }
+    return true;
+}
+
+// 过载判断（带迟滞）：排队数或排队时间超过高水位进入过载，两者都回落到低水位以下才恢复
+bool WebServer::Overloaded_() {
+    if (!threadpool_ && workers_.empty()) {
+        return false;
+    }
+    if (opts_.queueHighWater <= 0 && opts_.queueDelayHighUs <= 0) {
+        return false;
+    }
+    size_t depth = 0;
+    int64_t delayUs = 0;
+    if (threadpool_) {
+        threadpool_->Load(&depth, &delayUs);
+    }
+    for (auto& worker : workers_) {
+        // 连接亲和：排队数取总和，排队时间取最慢的队列
+        size_t d;
+        int64_t us;
+        worker->Load(&d, &us);
+        depth += d;
+        delayUs = std::max(delayUs, us);
+    }
+    bool depthHigh = opts_.queueHighWater > 0 && depth >= static_cast<size_t>(opts_.queueHighWater);
+    bool delayHigh = opts_.queueDelayHighUs > 0 && delayUs >= opts_.queueDelayHighUs;
+    bool depthLow = opts_.queueHighWater <= 0 || depth <= static_cast<size_t>(opts_.queueLowWater);
+    bool delayLow = opts_.queueDelayHighUs <= 0 || delayUs < opts_.queueDelayHighUs / 2;
+    if (!overloaded_ && (depthHigh || delayHigh)) {
+        overloaded_ = true;
+        stats_.overloads++;
+        LOG_WARN("Overloaded, queue depth: %zu, queue delay: %lld us", depth, (long long)delayUs);
+    } else if (overloaded_ && depthLow && delayLow) {
+        overloaded_ = false;
+        LOG_INFO("Overload cleared, queue depth: %zu, queue delay: %lld us", depth, (long long)delayUs);
+    }
+    return overloaded_;
+}
+
+// 过载解除后把监听 socket 重新加入 epoll
+void WebServer::ResumeAccept_(EventLoop* loop) {
+    if (Overloaded_()) {
+        return;
+    }
+    if (loop->listenFd >= 0) {
+        loop->epoller->AddFd(loop->listenFd, listenEvent_ | EPOLLIN);
+    }
+    if (loop->unixFd >= 0) {
+        loop->epoller->AddFd(loop->unixFd, listenEvent_ | EPOLLIN);
+    }
+    loop->acceptPaused = false;
+}
+
+// 主 Reactor 选择一个从 Reactor（轮询 / 连接数最少），把新连接放入其待处理队列并唤醒它
+void WebServer::HandOff_(int fd, const sockaddr_storage& addr) {
+    size_t idx = nextLoop_;
+    if (opts_.leastLoaded) {
+        for (size_t i = 1; i < loops_.size(); i++) {
+            if (loops_[i]->connCount < loops_[idx]->connCount) {
+                idx = i;
+            }
+        }
+    } else {
+        nextLoop_ = nextLoop_ + 1 < loops_.size() ? nextLoop_ + 1 : 1;
+    }
+    EventLoop* sub = loops_[idx].get();
+    sub->connCount++; // 提前计入，避免一批连接在从 Reactor 注册前都被分给同一个循环
+    {
+        std::lock_guard<std::mutex> locker(sub->pendingMtx);
+        sub->pending.emplace_back(fd, addr);
+    }
+    WakeUp_(sub);
+}
+
+// eventfd 可读：清空计数，把待处理队列中的连接注册到本循环
+void WebServer::DealWakeup_(EventLoop* loop) {
+    uint64_t one;
+    ssize_t n = read(loop->wakeupFd, &one, sizeof(one));
+    (void)n;
+    AddPending_(loop);
+    DrainCompletions_(loop);
+}
+
+// 取走整批待处理连接并注册到本循环（服务器关闭时直接关掉）
+void WebServer::AddPending_(EventLoop* loop) {
+    std::vector<std::pair<int, sockaddr_storage>> pending;
+    {
+        std::lock_guard<std::mutex> locker(loop->pendingMtx);
+        pending.swap(loop->pending);
+    }
+    for (auto& item : pending) {
+        loop->connCount--; // HandOff_ 已预先计入，AddClient_ 会再加一次
+        if (isClose_) {
+            close(item.first);
+            continue;
+        }
+        AddClient_(loop, item.first, item.second);
+    }
+}
+
+// 向循环的 eventfd 写 1，使其从 epoll_wait 返回
+void WebServer::WakeUp_(EventLoop* loop) {
+    uint64_t one = 1;
+    ssize_t n = write(loop->wakeupFd, &one, sizeof(one));
+    (void)n;
+}
+
+// 读事件分发：延长定时器并把读取任务交给线程池（多 Reactor 下直接在本循环线程读取）
+void WebServer::DealRead_(EventLoop* loop, HttpConn* client) {
     assert(client);
-    ExtentTime_(client);                                                // 延长该连接的超时时间
-    threadpool_->AddTask(std::bind(&WebServer::OnRead_, this, client)); // 交给线程池处理
+    ExtentTime_(loop, client); // 延长该连接的超时时间
+    if (!AdmitRequest_(loop, client)) {
+        return;
+    }
+    BeginRequest_(loop, client->GetFd());
+    if (!loop->doneNodes.empty()) {
+        ProactorRead_(loop, client);
+        return;
+    }
+    if (threadpool_ || !workers_.empty()) {
+        if (opts_.inlineThreshold > 0) {
+            DealReadInline_(loop, client);
+            return;
+        }
+        stats_.offloaded++;
+    }
+    Dispatch_(client, std::bind(&WebServer::OnRead_, this, loop, client)); // 交给线程池处理
+}
+
+// 自适应内联：非阻塞读在循环线程内完成；完整的 GET/HEAD 请求就地解析，响应不超过阈值则直接写出
+// （写不完时回到 EPOLLOUT，由线程池继续写），其余情况把处理或写出交给线程池
+void WebServer::DealReadInline_(EventLoop* loop, HttpConn* client) {
+    int readErrno = 0;
+    ssize_t ret = client->read(&readErrno);
+    if (ret <= 0 && readErrno != EAGAIN) {
+        CloseConn_(loop, client);
+        return;
+    }
+    if (!client->IsLightRequest()) {
+        stats_.offloaded++;
+        Dispatch_(client, std::bind(&WebServer::OnProcess, this, loop, client));
+        return;
+    }
+    client->process(true);
+    if (client->ToWriteBytes() > opts_.inlineThreshold) {
+        stats_.offloaded++;
+        Dispatch_(client, std::bind(&WebServer::OnWrite_, this, loop, client, false));
+        return;
+    }
+    stats_.inlined++;
+    OnWrite_(loop, client, true);
 }
 
-// 写事件分发：同样延长定时器并交给线程池
-void WebServer::DealWrite_(HttpConn* client) {
+// 写事件分发：同样延长定时器并交给线程池（多 Reactor 下直接在本循环线程写出）
+void WebServer::DealWrite_(EventLoop* loop, HttpConn* client) {
     assert(client);
-    ExtentTime_(client);
-    threadpool_->AddTask(std::bind(&WebServer::OnWrite_, this, client));
+    ExtentTime_(loop, client);
+    if (!loop->doneNodes.empty()) {
+        ProactorWrite_(loop, client);
+        return;
+    }
+    Dispatch_(client, std::bind(&WebServer::OnWrite_, this, loop, client, false));
+}
+
+// 连接亲和模式按 fd 选定工作线程；共享队列模式交给任意空闲线程；没有线程池（多 Reactor）时直接在本线程执行
+void WebServer::Dispatch_(HttpConn* client, std::function<void()> task) {
+    if (!workers_.empty()) {
+        workers_[client->GetFd() % workers_.size()]->AddTask(std::move(task));
+    } else if (threadpool_) {
+        threadpool_->AddTask(std::move(task));
+    } else {
+        task();
+    }
+}
+
+void WebServer::BeginRequest_(EventLoop* loop, int fd) {
+    if (loop->reqStart[fd] == 0) {
+        loop->reqStart[fd] = ServerStats::NowNs();
+    }
+}
+
+// 没有进行中的请求时，这次读事件开始一个新请求，从该 IP 的令牌桶取一个令牌；
+// 取不到则回复 429 并关闭（epoll 下先把已到达的请求读掉，避免带着未读数据 close 发出 RST 冲掉 429）
+bool WebServer::AdmitRequest_(EventLoop* loop, HttpConn* client) {
+    int fd = client->GetFd();
+    uint32_t key;
+    if (!limiter_ || loop->reqStart[fd] != 0 || !LimitKey(client->GetAddr(), &key) || limiter_->Acquire(key)) {
+        return true;
+    }
+    if (!loop->uring) {
+        int readErrno = 0;
+        client->read(&readErrno);
+    }
+    send(fd, LIMIT_RESPONSE, sizeof(LIMIT_RESPONSE) - 1, MSG_DONTWAIT);
+    stats_.ipRateRejects++;
+    CloseConn_(loop, client);
+    return false;
+}
+
+void WebServer::EndRequest_(EventLoop* loop, HttpConn* client) {
+    int fd = client->GetFd();
+    if (loop->reqStart[fd] != 0) {
+        stats_.RecordRequest(loop->reqStart[fd], client->ResponseCount());
+        loop->reqStart[fd] = 0;
+    }
 }
 
 // 调整/延长指定客户端的超时时间（在有活动时调用）
-void WebServer::ExtentTime_(HttpConn* client) {
+void WebServer::ExtentTime_(EventLoop* loop, HttpConn* client) {
     assert(client);
     if (timeoutMS_ > 0) {
-        timer_->adjust(client->GetFd(), timeoutMS_);
+        loop->timer->adjust(client->GetFd(), timeoutMS_);
     }
 }
 
 // 线程池中实际执行的读取逻辑：从 HttpConn 读取数据，若错误则关闭连接，否则继续处理请求
-void WebServer::OnRead_(HttpConn* client) {
+void WebServer::OnRead_(EventLoop* loop, HttpConn* client) {
     assert(client);
     int ret = -1;
     int readErrno = 0;
     ret = client->read(&readErrno);        // 调用 HttpConn::read，内部会把数据读到其 Buffer
     if (ret <= 0 && readErrno != EAGAIN) { // 出错且不是 EAGAIN（表示暂时无数据）
-        CloseConn_(client);
+        CloseConn_(loop, client);
         return;
     }
     // 读取成功或 EAGAIN（对于 ET 需要注意），进入请求处理流程
-    OnProcess(client);
+    OnProcess(loop, client);
 }
 
 // 处理请求：解析并准备响应；根据是否有响应数据设置下次 epoll 监听为写或继续读
-void WebServer::OnProcess(HttpConn* client) {
+void WebServer::OnProcess(EventLoop* loop, HttpConn* client) {
+    int fd = client->GetFd();
     if (client->process()) { // process() 解析请求并构造响应，返回 true 表示已准备好响应
-        epoller_->ModFd(client->GetFd(), connEvent_ | EPOLLOUT); // 监听可写以发送响应
+        if (!threadpool_) {
+            // 多 Reactor / 连接亲和：连接不会被其他线程同时处理，直接尝试写出，省去一次 EPOLLOUT 往返
+            OnWrite_(loop, client, false);
+            return;
+        }
+        loop->epoller->ModFd(fd, connEvent_ | EPOLLOUT, loop->users->Id(fd)); // 监听可写以发送响应
     } else {
-        epoller_->ModFd(client->GetFd(), connEvent_ | EPOLLIN); // 继续监听读
+        loop->epoller->ModFd(fd, connEvent_ | EPOLLIN, loop->users->Id(fd)); // 继续监听读
     }
 }
 
 // 线程池中实际执行的写逻辑：调用 HttpConn::write 将 iov 中数据写出
-void WebServer::OnWrite_(HttpConn* client) {
+// 一次 writev 有多段（带文件内容或流水线的多个响应）时先 cork 再 writev，写完（或写满发送缓冲区）后立即 uncork：
+// 内核只把凑满 MSS 的段发出去，响应头不会单独成段，多次 writev 的衔接处也不会产生小段；uncork 时发出尾部
+ssize_t WebServer::Write_(HttpConn* client, int* saveErrno) {
+    bool cork = opts_.tcpCork && client->WriteIovCnt() > 1 && client->GetAddr().ss_family != AF_UNIX;
+    int on = 1;
+    int off = 0;
+    if (cork) {
+        setsockopt(client->GetFd(), IPPROTO_TCP, TCP_CORK, &on, sizeof(on));
+        stats_.corked++;
+    }
+    ssize_t ret = client->write(saveErrno);
+    if (cork) {
+        setsockopt(client->GetFd(), IPPROTO_TCP, TCP_CORK, &off, sizeof(off));
+    }
+    return ret;
+}
+
+void WebServer::OnWrite_(EventLoop* loop, HttpConn* client, bool inLoop) {
     assert(client);
     int ret = -1;
     int writeErrno = 0;
-    ret = client->write(&writeErrno); // 调用写，返回写出字节数或错误码
+    ret = Write_(client, &writeErrno); // 调用写，返回写出字节数或错误码
     if (client->ToWriteBytes() == 0) {
         /* 如果剩余待写为 0，说明本次传输已完成 */
-        if (client->IsKeepAlive()) {
-            // 若是长连接，则继续处理新的请求（保持连接）
-            OnProcess(client);
+        EndRequest_(loop, client);
+        if (client->IsKeepAlive() && !draining_) {
+            // 若是长连接（排空中不再保持），则继续处理新的请求（保持连接）；
+            // 内联写出时仍在循环线程内，流水线中剩下的请求（可能要查数据库）交给线程池
+            if (inLoop && client->ReadBufferedBytes() > 0) {
+                stats_.offloaded++;
+                Dispatch_(client, std::bind(&WebServer::OnProcess, this, loop, client));
+                return;
+            }
+            OnProcess(loop, client);
             return;
         }
-    } else if (ret < 0) {
-        if (writeErrno == EAGAIN) {
-            /* 若写缓冲已满，等待下一次可写事件继续发送 */
-            epoller_->ModFd(client->GetFd(), connEvent_ | EPOLLOUT);
+    } else if (ret > 0 || writeErrno == EAGAIN) {
+        /* 若写缓冲已满（或 LT 模式下一次没写完，如生成内容的下一段），等待下一次可写事件继续发送 */
+        loop->epoller->ModFd(client->GetFd(), connEvent_ | EPOLLOUT, loop->users->Id(client->GetFd()));
+        return;
+    }
+    // 非长连接或写出失败，关闭连接
+    CloseConn_(loop, client);
+}
+
+// Proactor：非阻塞读在循环线程内完成，出错关闭，否则看请求是否已完整
+void WebServer::ProactorRead_(EventLoop* loop, HttpConn* client) {
+    int readErrno = 0;
+    ssize_t ret = client->read(&readErrno);
+    if (ret <= 0 && readErrno != EAGAIN) {
+        CloseConn_(loop, client);
+        return;
+    }
+    ProactorProcess_(loop, client);
+}
+
+// 请求不完整：继续监听读（部分到达的数据留在读缓冲区，不占用工作线程）
+// 请求完整：轻量请求在开启自适应内联时就地处理，其余交给工作线程；期间连接不在 epoll 中挂载，只有定时器可能要求关闭
+void WebServer::ProactorProcess_(EventLoop* loop, HttpConn* client) {
+    int fd = client->GetFd();
+    if (!client->IsRequestComplete()) {
+        loop->epoller->ModFd(fd, connEvent_ | EPOLLIN, loop->users->Id(fd));
+        return;
+    }
+    if (opts_.inlineThreshold > 0 && client->IsLightRequest()) {
+        stats_.inlined++;
+        client->process(true);
+        ProactorWrite_(loop, client);
+        return;
+    }
+    stats_.offloaded++;
+    loop->inflight[fd] = INFLIGHT_BUSY;
+    threadpool_->AddTask(std::bind(&WebServer::OnCompute_, this, loop, client));
+}
+
+// 工作线程只做计算，不碰 socket 和 epoll；完成后把连接的节点压入所属循环的完成队列，队列由空变非空时才写 eventfd
+void WebServer::OnCompute_(EventLoop* loop, HttpConn* client) {
+    client->process();
+    if (loop->completions.Push(&loop->doneNodes[client->GetFd()])) {
+        WakeUp_(loop);
+    }
+}
+
+// 循环线程取回工作线程处理完的连接并写出响应（等待期间被要求关闭的直接关闭）
+void WebServer::DrainCompletions_(EventLoop* loop) {
+    if (loop->doneNodes.empty()) {
+        return;
+    }
+    MpscNode* node = loop->completions.PopAll();
+    while (node) {
+        MpscNode* next = node->next; // 写完后同一节点可能被再次压入，先取出 next
+        int fd = static_cast<int>(node - &loop->doneNodes[0]);
+        HttpConn* client = loop->users->At(fd);
+        bool closing = loop->inflight[fd] == INFLIGHT_CLOSING;
+        loop->inflight[fd] = INFLIGHT_IDLE;
+        if (closing) {
+            CloseConn_(loop, client);
+        } else if (client->ResponseCount() == 0) {
+            ProactorProcess_(loop, client); // 只转存了请求体，还没有响应：继续读
+        } else {
+            ProactorWrite_(loop, client);
+        }
+        node = next;
+    }
+}
+
+// 循环线程写响应：写完后长连接继续处理缓冲区中的下一个请求（或等待可读），写缓冲满则等待可写
+void WebServer::ProactorWrite_(EventLoop* loop, HttpConn* client) {
+    int writeErrno = 0;
+    ssize_t ret = Write_(client, &writeErrno);
+    if (client->ToWriteBytes() == 0) {
+        EndRequest_(loop, client);
+        if (client->IsKeepAlive() && !draining_) {
+            ProactorProcess_(loop, client);
             return;
         }
+    } else if (ret > 0 || writeErrno == EAGAIN) {
+        loop->epoller->ModFd(client->GetFd(), connEvent_ | EPOLLOUT, loop->users->Id(client->GetFd()));
+        return;
     }
-    // 非长连接或写出失败，关闭连接
-    CloseConn_(client);
+    CloseConn_(loop, client);
 }
 
-/* Create listenFd 并绑定监听，同时把 listenFd 加入 epoll */
+// io_uring 事件循环：一次 io_uring_enter 同时提交上一轮产生的 recv/writev/close 并等待完成事件
+void WebServer::RunUringLoop_(EventLoop* loop) {
+    Uringer* ring = loop->uring.get();
+    // TCP 和 Unix 域监听各有一个在途 accept，各用一份地址缓冲
+    int listenFds[2] = {loop->listenFd, loop->unixFd};
+    for (int k = 0; k < 2; k++) {
+        if (listenFds[k] >= 0) {
+            UringAccept_(loop, k);
+        }
+    }
+    ring->Read(loop->wakeupFd, &loop->wakeupVal, sizeof(loop->wakeupVal),
+               (uint64_t)URING_WAKEUP << 32 | (uint32_t)loop->wakeupFd);
+
+    int timeMS = -1;
+    while (!isClose_) {
+        if (timeoutMS_ > 0) {
+            timeMS = loop->timer->GetNextTick();
+        }
+        if (loop->acceptRetryNs[0] > 0 || loop->acceptRetryNs[1] > 0) {
+            RetryUringAccept_(loop, &timeMS);
+        }
+        if (Drained_(loop, &timeMS)) {
+            break;
+        }
+        int eventCnt = ring->Wait(timeMS);
+        for (int i = 0; i < eventCnt; i++) {
+            uint64_t data = ring->GetData(i);
+            int op = static_cast<int>(data >> 32);
+            int fd = static_cast<int>(data & 0xffffffff);
+            int res = ring->GetRes(i);
+            switch (op) {
+                case URING_ACCEPT: OnUringAccept_(loop, fd == loop->unixFd ? 1 : 0, res); break;
+                case URING_WAKEUP:
+                    AddPending_(loop);
+                    ring->Read(fd, &loop->wakeupVal, sizeof(loop->wakeupVal), data);
+                    break;
+                case URING_RECV: OnUringRecv_(loop, i, fd, res); break;
+                case URING_WRITE: OnUringWrite_(loop, fd, res); break;
+                case URING_CLOSE: break;
+                case URING_CANCEL: break;
+                default: LOG_ERROR("Unexpected uring completion"); break;
+            }
+        }
+    }
+}
+
+void WebServer::UringAccept_(EventLoop* loop, int k) {
+    int listenFd = k == 1 ? loop->unixFd : loop->listenFd;
+    loop->acceptLen[k] = sizeof(loop->acceptAddr[k]);
+    loop->uring->Accept(listenFd, (sockaddr*)&loop->acceptAddr[k], &loop->acceptLen[k],
+                        (uint64_t)URING_ACCEPT << 32 | (uint32_t)listenFd);
+}
+
+// accept 完成后重新投递。fd 用尽（EMFILE/ENFILE）时立即投递会在下一次 io_uring_enter 中以同样的错误完成，
+// 循环空转占满 CPU，所以隔 ACCEPT_RETRY_MS 再试（期间新连接留在 backlog 中），同一次用尽只记一条日志
+void WebServer::OnUringAccept_(EventLoop* loop, int k, int res) {
+    if (res > 0) {
+        AcceptConn_(loop, res, loop->acceptAddr[k]);
+    } else if (res == -ECANCELED && loop->draining) {
+        return; // 排空中被取消，不再投递
+    } else if (res == -EMFILE || res == -ENFILE) {
+        if (loop->acceptRetryNs[k] == 0) {
+            LOG_ERROR("Accept failed: %s, retry every %d ms", strerror(-res), ACCEPT_RETRY_MS);
+        }
+        loop->acceptRetryNs[k] = ServerStats::NowNs() + static_cast<int64_t>(ACCEPT_RETRY_MS) * 1000000;
+        return;
+    } else if (res < 0) {
+        LOG_WARN("Accept failed: %s", strerror(-res));
+    }
+    if (loop->acceptRetryNs[k] != 0) {
+        LOG_INFO("Accept resumed");
+        loop->acceptRetryNs[k] = 0;
+    }
+    if (!loop->draining) {
+        UringAccept_(loop, k);
+    }
+}
+
+void WebServer::RetryUringAccept_(EventLoop* loop, int* timeMS) {
+    int64_t now = ServerStats::NowNs();
+    for (int k = 0; k < 2; k++) {
+        if (loop->acceptRetryNs[k] <= 0) {
+            continue;
+        }
+        int64_t waitMs = (loop->acceptRetryNs[k] - now + 999999) / 1000000;
+        if (waitMs <= 0) {
+            loop->acceptRetryNs[k] = -1; // 成功 accept 之前再次失败不重复记日志
+            UringAccept_(loop, k);
+            continue;
+        }
+        if (*timeMS < 0 || *timeMS > waitMs) {
+            *timeMS = static_cast<int>(waitMs);
+        }
+    }
+}
+
+// recv 完成：把 provided buffer 中的数据拷入读缓冲区并立即归还，然后处理请求
+void WebServer::OnUringRecv_(EventLoop* loop, size_t i, int fd, int res) {
+    HttpConn* client = loop->users->At(fd);
+    bool closing = loop->inflight[fd] == INFLIGHT_CLOSING;
+    loop->inflight[fd] = INFLIGHT_IDLE;
+    if (res > 0) {
+        client->AppendRead(loop->uring->GetBuffer(i), res);
+    }
+    loop->uring->RecycleBuffer(i);
+    if (closing || client->IsClose()) {
+        CloseConn_(loop, client);
+        return;
+    }
+    if (res == -ENOBUFS) {
+        UringRecv_(loop, client); // buffer ring 暂时用尽，重新投递
+        return;
+    }
+    if (res <= 0) {
+        CloseConn_(loop, client); // 对端关闭（0）或出错
+        return;
+    }
+    ExtentTime_(loop, client);
+    if (!AdmitRequest_(loop, client)) {
+        return;
+    }
+    BeginRequest_(loop, fd);
+    UringProcess_(loop, client);
+}
+
+// writev 完成：推进 iov_，没写完继续写；写完后长连接继续处理/读，否则关闭
+void WebServer::OnUringWrite_(EventLoop* loop, int fd, int res) {
+    HttpConn* client = loop->users->At(fd);
+    bool closing = loop->inflight[fd] == INFLIGHT_CLOSING;
+    loop->inflight[fd] = INFLIGHT_IDLE;
+    if (closing || client->IsClose() || res < 0) {
+        CloseConn_(loop, client);
+        return;
+    }
+    client->Advance(res);
+    if (client->ToWriteBytes() > 0) {
+        UringWrite_(loop, client);
+        return;
+    }
+    EndRequest_(loop, client);
+    if (client->IsKeepAlive() && !draining_) {
+        UringProcess_(loop, client);
+    } else {
+        CloseConn_(loop, client);
+    }
+}
+
+// 解析请求：已生成响应则提交 writev，否则继续 recv
+void WebServer::UringProcess_(EventLoop* loop, HttpConn* client) {
+    if (client->process()) {
+        UringWrite_(loop, client);
+    } else {
+        UringRecv_(loop, client);
+    }
+}
+
+void WebServer::UringRecv_(EventLoop* loop, HttpConn* client) {
+    int fd = client->GetFd();
+    loop->inflight[fd] = INFLIGHT_BUSY;
+    loop->uring->Recv(fd, (uint64_t)URING_RECV << 32 | (uint32_t)fd);
+}
+
+void WebServer::UringWrite_(EventLoop* loop, HttpConn* client) {
+    int fd = client->GetFd();
+    loop->inflight[fd] = INFLIGHT_BUSY;
+    loop->uring->Writev(fd, client->WriteIov(), client->WriteIovCnt(), (uint64_t)URING_WRITE << 32 | (uint32_t)fd);
+}
+
+/* Create listenFd 并绑定监听，同时把 listenFd 加入各事件循环的 epoll */
 bool WebServer::InitSocket_() {
-    int ret;
-    struct sockaddr_in addr;
+    bool tcp = opts_.unixPath.empty() || !opts_.unixOnly;
+    // 继承的监听 socket：Prefork 的 master 传入的、systemd 传入的优先，其次是旧进程经控制 socket 交来的；
+    // 按协议族分给 TCP / Unix 域监听
+    std::vector<int> inherited = !opts_.listenFds.empty() ? opts_.listenFds : ListenHandoff::FromSystemd();
+    if (inherited.empty() && !opts_.handoffPath.empty()) {
+        handoffConn_ = ListenHandoff::Request(opts_.handoffPath, &inherited);
+    }
+    std::vector<int> tcpFds;
+    for (int fd : inherited) {
+        sockaddr_storage addr;
+        socklen_t len = sizeof(addr);
+        if (getsockname(fd, (struct sockaddr*)&addr, &len) < 0) {
+            LOG_WARN("Inherited fd[%d] is not a socket", fd);
+            continue;
+        }
+        if (addr.ss_family == AF_UNIX && !opts_.unixPath.empty() && unixFd_ < 0) {
+            unixFd_ = fd;
+            unixOwner_ = handoffConn_ >= 0; // 从旧进程接管的 socket 文件此后归本进程
+        } else if (addr.ss_family != AF_UNIX && tcp) {
+            tcpFds.push_back(fd);
+        } else {
+            LOG_WARN("Inherited listen fd[%d] not used by this config, closed", fd);
+            close(fd);
+            continue;
+        }
+        SetFdNonblock(fd);
+    }
+    if (!inherited.empty()) {
+        LOG_INFO("Inherited %zu tcp and %d unix listen sockets", tcpFds.size(), unixFd_ >= 0 ? 1 : 0);
+    }
     // 检查端口号
-    if (port_ > 65535 || port_ < 1024) {
+    if (tcp && tcpFds.empty() && (port_ > 65535 || port_ < 1024)) {
         LOG_ERROR("Port:%d error!", port_);
         return false;
     }
+    if (!opts_.unixPath.empty() && unixFd_ < 0) {
+        unixFd_ = CreateUnixListenFd(opts_.unixPath, opts_.listenBacklog);
+        if (unixFd_ < 0) {
+            return false;
+        }
+        unixOwner_ = true;
+    }
+
+    // 多 Reactor + SO_REUSEPORT：每个循环各自一个监听 socket；否则只建一个（多 Reactor 时共享）
+    // 主从 Reactor：只有主 Reactor（0 号）监听
+    bool mainSub = opts_.reactorNum > 0 && opts_.mainSubReactor;
+    bool reusePort = opts_.reactorNum > 0 && !opts_.sharedListen && !mainSub;
+    bool worker = opts_.workerIndex >= 0; // Prefork 工作进程：各进程自建的 TCP 监听组成 SO_REUSEPORT 组
+    uint32_t listenEvent = listenEvent_ | EPOLLIN;
+    size_t listeners = mainSub ? 1 : loops_.size(); // 负责 accept 的循环数
+    if ((opts_.reactorNum > 0 && opts_.sharedListen && !mainSub) ||
+        (!tcpFds.empty() && (tcpFds.size() < listeners || worker))) {
+        // EPOLLEXCLUSIVE：一个新连接只唤醒一个等待的循环；该标志不能与 EPOLLRDHUP 同时使用
+        // 继承的监听 socket 比循环少、或由多个工作进程共享时同样如此
+        listenEvent = (listenEvent & ~EPOLLRDHUP) | EPOLLEXCLUSIVE;
+    }
+    // Unix 域 socket 不支持 SO_REUSEPORT 分流：多 Reactor 下所有循环（Prefork 下所有进程）共享一个，同样用 EPOLLEXCLUSIVE
+    uint32_t unixEvent = listenEvent_ | EPOLLIN;
+    if ((opts_.reactorNum > 0 && !mainSub) || worker) {
+        unixEvent = (unixEvent & ~EPOLLRDHUP) | EPOLLEXCLUSIVE;
+    }
+    for (auto& loop : loops_) {
+        if (mainSub && loop->id != 0) {
+            continue;
+        }
+        if (unixFd_ >= 0) {
+            loop->unixFd = unixFd_;
+            if (!loop->uring && !loop->epoller->AddFd(unixFd_, unixEvent)) {
+                LOG_ERROR("Add unix listen error!");
+                return false;
+            }
+        }
+        if (!tcp) {
+            continue;
+        }
+        if (!tcpFds.empty()) {
+            // 继承的监听 socket 依次分给各循环（旧进程的 SO_REUSEPORT 组整体沿用，backlog 中的连接不会丢）
+            loop->listenFd = tcpFds[loop->id % tcpFds.size()];
+            if (listenFd_ < 0) {
+                listenFd_ = loop->listenFd;
+            }
+        } else if (reusePort || listenFd_ < 0) {
+            loop->listenFd = CreateListenFd_(reusePort || worker);
+            if (loop->listenFd < 0) {
+                return false;
+            }
+            if (listenFd_ < 0) {
+                listenFd_ = loop->listenFd;
+            }
+        } else {
+            loop->listenFd = listenFd_;
+        }
+        // 将监听 fd 加入 epoll，监听 listenEvent_（如有 EPOLLET）以及读事件 EPOLLIN（io_uring 循环改为投递 accept）
+        if (!loop->uring && !loop->epoller->AddFd(loop->listenFd, listenEvent)) {
+            LOG_ERROR("Add listen error!");
+            return false;
+        }
+    }
+    for (size_t i = listeners; i < tcpFds.size(); i++) {
+        // 继承的比需要的多（新配置的循环更少）：多余的关闭，其 backlog 中尚未 accept 的连接会被内核重置
+        LOG_WARN("Extra inherited listen fd[%d] closed", tcpFds[i]);
+        close(tcpFds[i]);
+    }
+    if (tcp) {
+        LOG_INFO("Server port:%d", port_);
+    }
+    if (unixFd_ >= 0) {
+        LOG_INFO("Server unix socket:%s", opts_.unixPath.c_str());
+    }
+    return true;
+}
+
+// 创建 Unix 域监听 socket：路径上残留的 socket 文件若已无人监听（上次异常退出）则删除后重新绑定
+int WebServer::CreateUnixListenFd(const std::string& path, int backlog) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("Unix socket path too long: %s", path.c_str());
+        return -1;
+    }
+    strcpy(addr.sun_path, path.c_str());
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        LOG_ERROR("Create unix socket error!");
+        return -1;
+    }
+    struct stat st;
+    if (stat(addr.sun_path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+        // 能连上说明另一个进程正在监听，不能抢占；连不上才是残留文件
+        if (connect(listenFd, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+            LOG_ERROR("Unix socket %s is in use!", addr.sun_path);
+            close(listenFd);
+            return -1;
+        }
+        unlink(addr.sun_path);
+        close(listenFd); // 连接失败的 socket 不能再 bind，换一个新的
+        listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0) {
+            LOG_ERROR("Create unix socket error!");
+            return -1;
+        }
+    }
+    if (bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        LOG_ERROR("Bind unix socket %s error: %s", addr.sun_path, strerror(errno));
+        close(listenFd);
+        return -1;
+    }
+    if (listen(listenFd, backlog > 0 ? backlog : SOMAXCONN) < 0) {
+        LOG_ERROR("Listen unix socket %s error!", addr.sun_path);
+        close(listenFd);
+        unlink(addr.sun_path);
+        return -1;
+    }
+    SetFdNonblock(listenFd);
+    return listenFd;
+}
+
+// 创建监听 socket：设置 linger / 端口复用，bind + listen，并设为非阻塞；失败返回 -1
+int WebServer::CreateListenFd_(bool reusePort) {
+    int ret;
+    struct sockaddr_in addr;
     // 填充地址结构（监听所有网卡）
     addr.sin_family = AF_INET;
     addr.sin_addr.s_addr = htonl(INADDR_ANY);
@@ -268,56 +1462,68 @@ bool WebServer::InitSocket_() {
     }
 
     // 创建 socket
-    listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (listenFd_ < 0) {
+    int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) {
         LOG_ERROR("Create socket error!", port_);
-        return false;
+        return -1;
     }
 
     // 设置 SO_LINGER（无论 openLinger_ 是否设置，都调用 setsockopt；如果 openLinger_ == false，optLinger 是 {0,0}）
-    ret = setsockopt(listenFd_, SOL_SOCKET, SO_LINGER, &optLinger, sizeof(optLinger));
+    ret = setsockopt(listenFd, SOL_SOCKET, SO_LINGER, &optLinger, sizeof(optLinger));
     if (ret < 0) {
-        close(listenFd_);
+        close(listenFd);
         LOG_ERROR("Init linger error!", port_);
-        return false;
+        return -1;
     }
 
     int optval = 1;
     /* 端口复用，避免 TIME_WAIT 阻塞重启 */
     /* 只有最后一个套接字会正常接收数据。 */
-    ret = setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, (const void*)&optval, sizeof(int));
+    ret = setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, (const void*)&optval, sizeof(int));
     if (ret == -1) {
         LOG_ERROR("set socket setsockopt error !");
-        close(listenFd_);
-        return false;
+        close(listenFd);
+        return -1;
+    }
+
+    /* SO_REUSEPORT：多个 socket 绑定同一端口，内核在它们之间按连接哈希做负载均衡 */
+    if (reusePort) {
+        ret = setsockopt(listenFd, SOL_SOCKET, SO_REUSEPORT, (const void*)&optval, sizeof(int));
+        if (ret == -1) {
+            LOG_ERROR("set SO_REUSEPORT error !");
+            close(listenFd);
+            return -1;
+        }
+    }
+
+    // TCP Fast Open 须在 listen 之前设置；失败（内核不支持）只告警，不影响监听
+    if (opts_.fastOpenQueue > 0 &&
+        setsockopt(listenFd, IPPROTO_TCP, TCP_FASTOPEN, &opts_.fastOpenQueue, sizeof(opts_.fastOpenQueue)) < 0) {
+        LOG_WARN("set TCP_FASTOPEN error: %s", strerror(errno));
+    }
+    if (opts_.deferAcceptSec > 0 &&
+        setsockopt(listenFd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &opts_.deferAcceptSec, sizeof(opts_.deferAcceptSec)) < 0) {
+        LOG_WARN("set TCP_DEFER_ACCEPT error: %s", strerror(errno));
     }
 
     // 绑定端口
-    ret = bind(listenFd_, (struct sockaddr*)&addr, sizeof(addr));
+    ret = bind(listenFd, (struct sockaddr*)&addr, sizeof(addr));
     if (ret < 0) {
         LOG_ERROR("Bind Port:%d error!", port_);
-        close(listenFd_);
-        return false;
+        close(listenFd);
+        return -1;
     }
 
     // 监听
-    ret = listen(listenFd_, 6);
+    ret = listen(listenFd, opts_.listenBacklog > 0 ? opts_.listenBacklog : SOMAXCONN);
     if (ret < 0) {
         LOG_ERROR("Listen port:%d error!", port_);
-        close(listenFd_);
-        return false;
-    }
-    // 将监听 fd 加入 epoll，监听 listenEvent_（如有 EPOLLET）以及读事件 EPOLLIN
-    ret = epoller_->AddFd(listenFd_, listenEvent_ | EPOLLIN);
-    if (ret == 0) {
-        LOG_ERROR("Add listen error!");
-        close(listenFd_);
-        return false;
+        close(listenFd);
+        return -1;
     }
     // 将监听 socket 设置为非阻塞
-    SetFdNonblock(listenFd_);
-    LOG_INFO("Server port:%d", port_);
-    return true;
+    SetFdNonblock(listenFd);
+    return listenFd;
 }
 
 // 设置文件描述符为非阻塞（返回 fcntl 的结果）
@@ -1,68 +1,203 @@
 #ifndef WEBSERVER_H
 #define WEBSERVER_H
 
-#include <unordered_map> // 用于存储 fd 到 HttpConn 的映射（用户连接）
+#include <vector>        // 多个事件循环
+#include <thread>        // 多 Reactor 的事件循环线程
+#include <atomic>        // isClose_ 跨线程可见
+#include <mutex>         // 保护从 Reactor 的待处理连接队列
+#include <algorithm>     // std::find（监听 fd 去重）、std::max
+#include <poll.h>        // 控制 socket 线程的定时等待
+#include <sys/eventfd.h> // eventfd()，跨线程唤醒事件循环
+#include <signal.h>      // 忽略 SIGPIPE
 #include <fcntl.h>       // fcntl()，设置非阻塞
 #include <unistd.h>      // close()
 #include <assert.h>      // assert 断言
 #include <errno.h>       // errno 系统错误码
 #include <sys/socket.h>  // socket(), bind(), listen(), accept()
 #include <netinet/in.h>  // sockaddr_in 结构（网络地址）
+#include <sys/un.h>      // sockaddr_un，Unix 域监听
+#include <sys/stat.h>    // stat()，启动时只删除残留的 socket 文件
+#include <netinet/tcp.h> // TCP_NODELAY / TCP_CORK / TCP_DEFER_ACCEPT / TCP_FASTOPEN
 #include <arpa/inet.h>   // htonl/htons，网络字节序转换
 
 #include "epoller.h"             // epoll 封装类
+#include "uringer.h"             // io_uring 封装类
+#include "connslab.h"            // 按 fd 下标的连接槽数组
+#include "serveroptions.h"       // 扩展配置（多 Reactor 等）
+#include "serverstats.h"         // 运行统计（请求数、耗时分布）
+#include "clientlimiter.h"       // 按客户端 IP 的连接数/请求速率限制
+#include "tcpcounters.h"         // 内核 TCP 计数器快照（socket 参数的效果）
+#include "listenhandoff.h"       // 监听 socket 继承（零停机重启）
 #include "../log/log.h"          // 日志系统
 #include "../timer/heaptimer.h"  // 小根堆定时器（用于连接超时）
 #include "../pool/sqlconnpool.h" // MySQL 连接池
 #include "../pool/threadpool.h"  // 线程池
+#include "../pool/mpscqueue.h"   // 无锁完成队列（Proactor）
 #include "../pool/sqlconnpool.h" // RAII 管理数据库连接
 #include "../http/httpconn.h"    // HTTP 连接处理类
+#include "../http/httpscan.h"    // 请求头扫描实现（启动时写日志）
 
 class WebServer {
 public:
     // 构造函数: 设置服务器参数　＋　初始化定时器／线程池／反应堆／连接队列
     WebServer(int port, int trigMode, int timeoutMS, bool OptLinger, int sqlPort, const char* sqlUser,
               const char* sqlPwd, const char* dbName, int connPoolNum, int threadNum, bool openLog, int logLevel,
-              int logQueSize);
+              int logQueSize, const ServerOptions& opts = ServerOptions());
 
     ~WebServer(); // 析构函数: 关闭listenFd_，　销毁　连接队列/定时器／线程池／反应堆
-    void Start(); // 服务器启动（事件循环）
+    void Start(); // 服务器启动（事件循环），排空结束后返回
+
+    // 开始排空：停止 accept，关闭空闲连接，进行中的请求完成后关闭，全部关闭或 drainTimeoutMs 到期后 Start() 返回。
+    // 只做原子写和 eventfd 写，可以在信号处理函数中调用
+    void Drain();
+
+    const ServerStats& Stats() const { // 运行统计（Prefork 工作进程中为共享内存里本进程的那一份）
+        return stats_;
+    }
+
+    // 创建、绑定并监听 Unix 域 socket（处理残留的 socket 文件），失败返回 -1；Prefork 的 master 也用它创建共享的监听
+    static int CreateUnixListenFd(const std::string& path, int backlog);
 
 private:
-    bool InitSocket_();                        // 初始化监听 socket
-    void InitEventMode_(int trigMode);         // 设置 EPOLL 触发模式（ET/LT）
-    void AddClient_(int fd, sockaddr_in addr); // 接收新连接并添加到 epoll
+    // 事件循环：独占一个 Epoller、一个 HeapTimer 和自己的一批连接，只在所属线程上运行
+    struct EventLoop {
+        int id;                                  // 循环编号（0 号运行在主线程）
+        int listenFd;                            // 本循环监听的 TCP socket（-1 表示不负责 accept）
+        int unixFd;                              // 本循环监听的 Unix 域 socket（-1 表示没有）
+        int wakeupFd;                            // eventfd，其他线程写入以唤醒本循环的 epoll_wait
+        std::unique_ptr<Epoller> epoller;        // epoll 封装
+        std::unique_ptr<HeapTimer> timer;        // 小根堆定时器（管理本循环连接的超时）
+        std::unique_ptr<ConnSlab> users;         // fd -> HttpConn 连接槽（只由本循环线程启用）
+        std::atomic<int> connCount;              // 本循环当前连接数（供主 Reactor 选择最空闲的从 Reactor）
+        std::thread thread;                      // 运行本循环的线程（0 号循环为空）
+
+        std::mutex pendingMtx;                            // 保护 pending
+        std::vector<std::pair<int, sockaddr_storage>> pending; // 主 Reactor 交过来、尚未注册的连接
+
+        std::unique_ptr<Uringer> uring;  // io_uring 后端（为空则由 epoller 驱动）
+        std::vector<uint8_t> inflight;   // fd -> 在途 io_uring recv/writev 或 Proactor 计算的状态（INFLIGHT_STATE）
+        std::vector<int64_t> reqStart;   // fd -> 当前请求的读事件到达时间（ns，0 表示没有进行中的请求）
+        sockaddr_storage acceptAddr[2];  // 在途 accept 的对端地址（0：TCP，1：Unix 域）
+        socklen_t acceptLen[2];          // 在途 accept 的地址长度
+        int64_t acceptRetryNs[2];        // io_uring accept 因 fd 用尽失败后重新投递的时间（ns）；0 为正常，
+                                         // -1 为已重新投递、还没有成功过
+        uint64_t wakeupVal;              // 在途 eventfd read 的缓冲
+        bool acceptPaused;               // 过载保护暂停了 accept（监听 socket 已移出 epoll）
+        bool draining;                   // 本循环已进入排空（已停止 accept、关闭了空闲连接）
+
+        MpscQueue completions;           // Proactor：工作线程处理完的连接（节点取自 doneNodes）
+        std::vector<MpscNode> doneNodes; // fd -> 完成队列节点（每个连接同时最多一个请求在工作线程中）
+    };
+
+    // io_uring 完成事件的类型，与 fd 一起编码在 user_data 中
+    enum URING_OP {
+        URING_ACCEPT = 1,
+        URING_WAKEUP,
+        URING_RECV,
+        URING_WRITE,
+        URING_CLOSE,
+        URING_CANCEL,
+    };
+    // 连接的在途状态：空闲 / 有 io_uring recv、writev 或 Proactor 计算在途 / 在途期间被要求关闭（完成时再关）
+    enum INFLIGHT_STATE {
+        INFLIGHT_IDLE = 0,
+        INFLIGHT_BUSY,
+        INFLIGHT_CLOSING,
+    };
+
+    bool InitSocket_();                                         // 初始化监听 socket
+    int CreateListenFd_(bool reusePort);                        // 创建、绑定并监听一个 socket
+    void InitEventMode_(int trigMode);                          // 设置 EPOLL 触发模式（ET/LT）
+    void AddClient_(EventLoop* loop, int fd, const sockaddr_storage& addr); // 接收新连接并添加到 epoll
+
+    void RunLoop_(EventLoop* loop);              // 事件循环主体
+    void PlaceLoop_(EventLoop* loop);            // 绑核并让本循环的连接槽就近分配
+    int BusyWait_(EventLoop* loop, int timeMS);  // 先自旋轮询再阻塞等待 epoll 事件
+    void SetBusyPoll_(int fd);                   // 对连接设置 SO_BUSY_POLL / SO_PREFER_BUSY_POLL
+    bool Overloaded_();                          // 按线程池排队数/排队时间更新并返回过载状态
+    void ResumeAccept_(EventLoop* loop);         // 过载解除后恢复 accept
+    bool Drained_(EventLoop* loop, int* timeMS); // 排空中：连接已全部关闭或到期时返回 true（循环退出）
+    void BeginDrain_(EventLoop* loop);           // 本循环停止 accept 并关闭空闲连接
+    void HandoffLoop_();                         // 控制 socket 线程：把监听 socket 交给新进程后开始排空
+    std::vector<int> ListenFds_() const;         // 所有循环的监听 fd（去重）
+    void DealListen_(EventLoop* loop, int listenFd); // 处理 listening socket（accept）
+    void DealWakeup_(EventLoop* loop);           // 处理 eventfd 唤醒
+    void AddPending_(EventLoop* loop);           // 注册主 Reactor 交来的连接
+    void HandOff_(int fd, const sockaddr_storage& addr); // 主 Reactor 把新连接交给一个从 Reactor
+    static void WakeUp_(EventLoop* loop);        // 唤醒指定循环
+
+    bool AcceptConn_(EventLoop* loop, int fd, const sockaddr_storage& addr); // 接纳一个 accept 到的连接
+    void DealWrite_(EventLoop* loop, HttpConn*);                  // socket 可写
+    void DealRead_(EventLoop* loop, HttpConn*);                   // socket 可读
+    void DealReadInline_(EventLoop* loop, HttpConn*);             // 自适应内联：循环线程读取，轻量请求就地处理
+    void Dispatch_(HttpConn* client, std::function<void()> task); // 把读写任务交给工作线程
+
+    void SendError_(int fd, const char* info);           // 发送错误并关闭
+    void ExtentTime_(EventLoop* loop, HttpConn* client); // 延长连接的超时时间
+    void CloseConn_(EventLoop* loop, HttpConn* client);  // 关闭一个连接
+    void OnTimeout_(EventLoop* loop, uint64_t id);       // 定时器到期：id 未过期才关闭连接
 
-    void DealListen_();         // 处理 listening socket（accept）
-    void DealWrite_(HttpConn*); // socket 可写
-    void DealRead_(HttpConn*);  // socket 可读
+    void OnRead_(EventLoop* loop, HttpConn* client);   // 读数据（线程执行）
+    void OnWrite_(EventLoop* loop, HttpConn* client, bool inLoop); // 写数据（线程执行；inLoop：内联时在循环线程写出）
+    ssize_t Write_(HttpConn* client, int* saveErrno);  // writev 写出响应（按配置用 TCP_CORK 包住）
+    void OnProcess(EventLoop* loop, HttpConn* client); // 处理 HTTP 请求，生成响应
+    void BeginRequest_(EventLoop* loop, int fd);       // 记录请求开始时间（已在进行中则不变）
+    bool AdmitRequest_(EventLoop* loop, HttpConn* client); // 新请求按 IP 取令牌，取不到则回复 429 并关闭连接
 
-    void SendError_(int fd, const char* info); // 发送错误并关闭
-    void ExtentTime_(HttpConn* client);        // 延长连接的超时时间
-    void CloseConn_(HttpConn* client);         // 关闭一个连接
+    void ProactorRead_(EventLoop* loop, HttpConn* client);    // Proactor：循环线程读数据
+    void ProactorProcess_(EventLoop* loop, HttpConn* client); // 请求完整则交给工作线程，否则继续等待可读
+    void ProactorWrite_(EventLoop* loop, HttpConn* client);   // 循环线程写响应
+    void OnCompute_(EventLoop* loop, HttpConn* client);       // 工作线程：解析请求、生成响应，放入完成队列
+    void DrainCompletions_(EventLoop* loop);                  // 取出完成队列，写出各连接的响应
+    void EndRequest_(EventLoop* loop, HttpConn* client);      // 响应写完，记录请求耗时（流水线的一批计入多个请求）
 
-    void OnRead_(HttpConn* client);   // 读数据（线程执行）
-    void OnWrite_(HttpConn* client);  // 写数据（线程执行）
-    void OnProcess(HttpConn* client); // 处理 HTTP 请求，生成响应
+    void RunUringLoop_(EventLoop* loop);                           // io_uring 事件循环主体
+    void OnUringRecv_(EventLoop* loop, size_t i, int fd, int res); // recv 完成
+    void OnUringWrite_(EventLoop* loop, int fd, int res);          // writev 完成
+    void UringProcess_(EventLoop* loop, HttpConn* client);         // 处理请求后提交 writev 或下一次 recv
+    void UringRecv_(EventLoop* loop, HttpConn* client);            // 提交 recv
+    void UringAccept_(EventLoop* loop, int k);                     // 提交 accept（k：0 为 TCP，1 为 Unix 域）
+    void OnUringAccept_(EventLoop* loop, int k, int res);          // accept 完成
+    void RetryUringAccept_(EventLoop* loop, int* timeMS);          // 到时间的 accept 重新投递，否则缩短等待
+    void UringWrite_(EventLoop* loop, HttpConn* client);           // 提交 writev
 
     static const int MAX_FD = 65536; // 最大支持客户端连接数
+    static const int ACCEPT_RETRY_MS = 100; // io_uring accept 遇到 EMFILE/ENFILE 后隔多久再试
 
     static int SetFdNonblock(int fd); // 设置非阻塞
 
-    int port_;        // 监听端口
-    bool openLinger_; // 是否使用优雅关闭（SO_LINGER）
-    int timeoutMS_;   // 超时时间（毫秒）
-    bool isClose_;    // 服务器是否关闭
-    int listenFd_;    // 监听 socket fd
-    char* srcDir_;    // 网站资源目录（./resources）
+    int port_;                     // 监听端口
+    bool openLinger_;              // 是否使用优雅关闭（SO_LINGER）
+    int timeoutMS_;                // 超时时间（毫秒）
+    std::atomic<bool> isClose_;    // 服务器是否关闭（多个循环线程共享）
+    int listenFd_;                 // 监听 socket fd（SO_REUSEPORT 时为 0 号循环的监听 fd）
+    int unixFd_;                   // Unix 域监听 socket fd（各循环共享，-1 表示未启用）
+    bool unixOwner_;               // socket 文件由本进程创建或经交接接管（退出时删除）；systemd / master 传入的不删
+    char* srcDir_;                 // 网站资源目录（./resources）
+    ServerOptions opts_;           // 扩展配置
+    std::vector<int> reactorCpus_; // 解析后的事件循环绑核列表（空表示不绑定）
+    std::vector<int> workerCpus_;  // 解析后的工作线程绑核列表
 
     uint32_t listenEvent_; // epoll 监听 socket 的事件类型
     uint32_t connEvent_;   // epoll 客户端连接的事件类型
 
-    std::unique_ptr<HeapTimer> timer_;        // 小根堆定时器（管理连接超时）
-    std::unique_ptr<ThreadPool> threadpool_;  // 线程池
-    std::unique_ptr<Epoller> epoller_;        // epoll 封装
-    std::unordered_map<int, HttpConn> users_; // fd -> HttpConn 连接
+    std::unique_ptr<ThreadPool> threadpool_;           // 线程池（多 Reactor / 连接亲和模式下为空）
+    std::vector<std::unique_ptr<ThreadPool>> workers_; // 连接亲和模式下每个工作线程一个单线程池（按 fd 选择）
+    std::vector<std::unique_ptr<EventLoop>> loops_;    // 事件循环（单 Reactor 时只有一个；主从 Reactor 时 0 号为主 Reactor）
+    size_t nextLoop_;                                  // 主从 Reactor 轮询分配的下一个从 Reactor
+    ServerStats ownStats_;                             // 本进程的运行统计（未使用共享内存时）
+    ServerStats& stats_;                               // 运行统计（ownStats_ 或 opts.sharedStats）
+    std::atomic<bool> busyPollWarned_;                 // SO_BUSY_POLL 设置失败只告警一次
+    bool overloaded_;                                  // 当前是否处于过载状态（只由 0 号循环线程读写）
+    std::unique_ptr<ClientLimiter> limiter_;           // 按 IP 限流（未配置时为空）
+    TcpCounters tcpStart_;                             // 启动时的内核 TCP 计数器
+    bool tcpStartOk_;                                  // tcpStart_ 是否读取成功
+    std::atomic<bool> draining_;                       // 是否在排空（Drain() 后为 true）
+    std::atomic<int64_t> drainDeadlineNs_;             // 排空期限（ServerStats::NowNs 时间）
+    int handoffFd_;                                    // 控制 socket（-1 表示未启用）
+    int handoffConn_;                                  // 新进程：与旧进程的控制连接，Start() 时确认接管
+    std::thread handoffThread_;                        // 等待新进程连接控制 socket 的线程
+    std::atomic<bool> handedOff_;                      // 监听 socket 已交给新进程（退出时不再删除 socket 文件）
 };
 
 #endif // WEBSERVER_H
\ No newline at end of file
@@ -0,0 +1,153 @@
+// 稳态下每个请求的堆分配次数：替换 malloc 系列函数计数，经 socketpair 驱动一个 HttpConn 走完
+// 读 -> 解析 -> 生成响应 -> writev 的整个流程（不经过事件循环和线程池，日志关闭）
+// 用法：在项目根目录下运行 ./test/alloctest [每种请求的次数=10000]（需要 resources/）
+// 每种请求先预热，再统计之后平均每个请求的 malloc 次数；有任何一种不为 0 时返回 1
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <string>
+#include "../code/http/httpconn.h"
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t align, size_t size);
+void __libc_free(void* ptr);
+}
+
+static bool g_counting = false;
+static size_t g_mallocs = 0;
+
+// glibc 允许程序自己提供 malloc / free / calloc / realloc（operator new 也经由 malloc）
+extern "C" void* malloc(size_t size) {
+    g_mallocs += g_counting;
+    return __libc_malloc(size);
+}
+extern "C" void* calloc(size_t n, size_t size) {
+    g_mallocs += g_counting;
+    return __libc_calloc(n, size);
+}
+extern "C" void* realloc(void* ptr, size_t size) {
+    g_mallocs += g_counting;
+    return __libc_realloc(ptr, size);
+}
+extern "C" void* memalign(size_t align, size_t size) {
+    g_mallocs += g_counting;
+    return __libc_memalign(align, size);
+}
+extern "C" int posix_memalign(void** ptr, size_t align, size_t size) {
+    g_mallocs += g_counting;
+    *ptr = __libc_memalign(align, size);
+    return *ptr ? 0 : ENOMEM;
+}
+extern "C" void* aligned_alloc(size_t align, size_t size) {
+    g_mallocs += g_counting;
+    return __libc_memalign(align, size);
+}
+extern "C" void free(void* ptr) {
+    __libc_free(ptr);
+}
+
+static HttpConn g_conn;
+static int g_peer = -1;
+static char g_scratch[256 * 1024];
+
+// 发出 req，驱动连接处理并读回全部响应；返回读到的字节数（出错时为 0）
+static size_t RoundTrip(const std::string& req) {
+    if (send(g_peer, req.data(), req.size(), 0) != static_cast<ssize_t>(req.size())) {
+        return 0;
+    }
+    int err = 0;
+    if (g_conn.read(&err) <= 0 || !g_conn.process()) {
+        return 0;
+    }
+    size_t total = g_conn.ToWriteBytes();
+    size_t got = 0;
+    while (got < total) {
+        if (g_conn.ToWriteBytes() > 0 && g_conn.write(&err) < 0 && err != EAGAIN) {
+            return 0;
+        }
+        ssize_t n = recv(g_peer, g_scratch, sizeof(g_scratch), MSG_DONTWAIT);
+        if (n > 0) {
+            got += n;
+        }
+    }
+    return got;
+}
+
+int main(int argc, char* argv[]) {
+    int iters = argc > 1 ? atoi(argv[1]) : 10000;
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+        perror("socketpair");
+        return 1;
+    }
+    fcntl(sv[0], F_SETFL, O_NONBLOCK);
+    fcntl(sv[1], F_SETFL, O_NONBLOCK);
+    g_peer = sv[1];
+    static std::string srcDir = std::string(getcwd(g_scratch, sizeof(g_scratch))) + "/resources/";
+    HttpConn::srcDir = srcDir.c_str();
+    HttpConn::isET = false;
+    HttpConn::AddSiteRoutes(HttpConn::router); // "/" 等页面经路由表返回
+    sockaddr_storage addr = {};
+    addr.ss_family = AF_UNIX;
+    g_conn.init(sv[0], addr);
+
+    std::string multipart = "--bnd\r\nContent-Disposition: form-data; name=\"title\"\r\n\r\nhello world\r\n"
+                            "--bnd\r\nContent-Disposition: form-data; name=\"tags\"\r\n\r\na,b\r\n--bnd--\r\n";
+    multipart = "POST /index.html HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n"
+                "Content-Type: multipart/form-data; boundary=bnd\r\nContent-Length: " +
+                std::to_string(multipart.size()) + "\r\n\r\n" + multipart;
+    std::string pipelined;
+    for (int i = 0; i < 8; i++) {
+        pipelined += "GET /index.html HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n\r\n";
+    }
+    struct Case {
+        const char* name;
+        std::string req;
+        int count; // req 中的请求个数
+    };
+    const Case CASES[] = {
+        {"index", "GET /index.html HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n\r\n", 1},
+        {"dir", "GET / HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n\r\n", 1},
+        {"long path", "GET /images/profile-image.jpg HTTP/1.1\r\nHost: localhost\r\n"
+                      "User-Agent: Mozilla/5.0 (X11; Linux x86_64)\r\nAccept: image/avif,image/webp,*/*\r\n"
+                      "Connection: keep-alive\r\n\r\n", 1},
+        {"404", "GET /no/such/file.html HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n\r\n", 1},
+        {"form", "POST /index.html HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n"
+                 "Content-Type: application/x-www-form-urlencoded\r\nContent-Length: 38\r\n\r\n"
+                 "title=hello+world%21&tags=a%2Cb&empty=", 1},
+        {"multipart", multipart, 1},
+        {"pipelined", pipelined, 8},
+    };
+
+    int failed = 0;
+    printf("%-10s %10s %14s\n", "request", "bytes", "mallocs/req");
+    for (const Case& c : CASES) {
+        size_t bytes = 0;
+        for (int i = 0; i < 100; i++) { // 预热：缓冲区、字符串容量等长到稳态
+            bytes = RoundTrip(c.req);
+        }
+        g_mallocs = 0;
+        g_counting = true;
+        for (int i = 0; i < iters && bytes > 0; i++) {
+            bytes = RoundTrip(c.req);
+        }
+        g_counting = false;
+        if (bytes == 0) {
+            printf("%-10s round trip failed\n", c.name);
+            failed++;
+            continue;
+        }
+        double perReq = static_cast<double>(g_mallocs) / iters / c.count;
+        printf("%-10s %10zu %14.2f\n", c.name, bytes, perReq);
+        failed += g_mallocs > 0;
+    }
+    g_conn.Close();
+    close(g_peer);
+    return failed > 0;
+}
@@ -0,0 +1,178 @@
+// 路由查找：先检查精确、参数、前缀匹配和方法分派的结果，再比较注册 10 ~ 10000 条路由时
+// HttpRouter（压缩前缀树）与逐条比较模式（原 ParsePath_ 遍历 DEFAULT_HTML 的做法）的单核查找速度
+// 用法：./routebench [每档的查找次数=1000000]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "../code/http/httprouter.h"
+#include "../code/http/httprequest.h"
+#include "../code/http/httpresponse.h"
+
+static int g_failed = 0;
+static int g_hit = -1; // 最近一次调用的处理函数的编号
+static HttpRequest g_req;
+static HttpResponse g_resp;
+
+// 处理函数只记下自己的编号，不生成响应
+static HttpRouter::Handler Tag(int id) {
+    return [id](const HttpRequest&, const HttpRouter::Params&, HttpResponse&) {
+        g_hit = id;
+        return true;
+    };
+}
+
+static void Expect(const HttpRouter& router, HttpNames::METHOD method, const char* path, int want,
+                   const char* param = nullptr, const char* value = nullptr) {
+    HttpRouter::Params params;
+    const HttpRouter::Handler* h = router.Find(method, path, strlen(path), &params);
+    g_hit = -1;
+    if (h) {
+        (*h)(g_req, params, g_resp);
+    }
+    bool ok = g_hit == want;
+    if (ok && param) {
+        HttpParser::StrView v = params.Get(param);
+        ok = v.data && v.Equals(value);
+    }
+    if (!ok) {
+        printf("FAIL method %d %s: got %d, want %d\n", method, path, g_hit, want);
+        g_failed++;
+    }
+}
+
+static void CheckSemantics() {
+    HttpRouter r;
+    r.Get("/", Tag(1));
+    r.Get("/user/new", Tag(2));
+    r.Get("/user/:id", Tag(3));
+    r.Post("/user/:id", Tag(4));
+    r.Get("/user/:id/posts/:post", Tag(5));
+    r.Get("/static/*file", Tag(6));
+    r.Any("/login", Tag(7));
+    r.Post("/login", Tag(8));
+    r.Get("/users", Tag(9));
+    r.Get("/user/newsletter", Tag(10));
+    Expect(r, HttpNames::M_GET, "/", 1);
+    Expect(r, HttpNames::M_GET, "/user/new", 2);
+    Expect(r, HttpNames::M_GET, "/user/newer", 3, "id", "newer"); // 静态分支走不通，回到参数
+    Expect(r, HttpNames::M_GET, "/user/42", 3, "id", "42");
+    Expect(r, HttpNames::M_POST, "/user/42", 4, "id", "42");
+    Expect(r, HttpNames::M_DELETE, "/user/42", -1);
+    Expect(r, HttpNames::M_GET, "/user/42/posts/7?x=1", 5, "post", "7");
+    Expect(r, HttpNames::M_GET, "/user/", -1);
+    Expect(r, HttpNames::M_GET, "/static/css/a.css", 6, "file", "css/a.css");
+    Expect(r, HttpNames::M_GET, "/static/", 6, "file", "");
+    Expect(r, HttpNames::M_GET, "/login", 7);
+    Expect(r, HttpNames::M_POST, "/login", 8);
+    Expect(r, HttpNames::M_UNKNOWN, "/login", 7);
+    Expect(r, HttpNames::M_GET, "/users", 9);
+    Expect(r, HttpNames::M_GET, "/user/newsletter", 10);
+    Expect(r, HttpNames::M_GET, "/nope", -1);
+    if (r.Get("/user/:name", Tag(11)) || r.Get("/a/*x/b", Tag(11)) || r.Get("/a:b", Tag(11)) || r.Get("a", Tag(11))) {
+        printf("FAIL bad patterns accepted\n");
+        g_failed++;
+    }
+}
+
+// 逐条比较：和 HttpRouter 同样的模式语法，依次试每条路由
+struct LinearRouter {
+    std::vector<std::string> patterns;
+
+    static bool Match(const std::string& pat, const char* p, const char* end) {
+        size_t i = 0;
+        while (i < pat.size()) {
+            if (pat[i] == '*') {
+                return true;
+            }
+            if (pat[i] == ':') {
+                const char* seg = p;
+                while (p < end && *p != '/') {
+                    p++;
+                }
+                if (p == seg) {
+                    return false;
+                }
+                while (i < pat.size() && pat[i] != '/') {
+                    i++;
+                }
+                continue;
+            }
+            if (p == end || *p != pat[i]) {
+                return false;
+            }
+            p++;
+            i++;
+        }
+        return p == end;
+    }
+    int Find(const char* path, size_t len) const {
+        for (size_t i = 0; i < patterns.size(); i++) {
+            if (Match(patterns[i], path, path + len)) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+};
+
+template <typename F>
+static double Measure(int iters, F f) {
+    auto start = std::chrono::steady_clock::now();
+    f(iters);
+    std::chrono::duration<double> sec = std::chrono::steady_clock::now() - start;
+    return iters / sec.count();
+}
+
+int main(int argc, char* argv[]) {
+    int iters = argc > 1 ? atoi(argv[1]) : 1000000;
+    CheckSemantics();
+    printf("semantics: %s\n\n", g_failed ? "FAILED" : "ok");
+
+    // 网站自带页面 + 一批 REST 风格的接口；查找的路径分布在各处，最后一个不存在
+    static const char* PATHS[] = {
+        "/login", "/api/v1/res0/42", "/api/v1/res4999/42/items", "/static/js/app.min.js", "/api/v1/nope/1",
+    };
+    printf("%8s %14s %14s %8s   (lookups/s)\n", "routes", "linear", "radix", "speedup");
+    for (int n : {10, 100, 1000, 10000}) {
+        HttpRouter router;
+        LinearRouter linear;
+        auto add = [&](const std::string& pat) {
+            router.Get(pat, Tag(1));
+            linear.patterns.push_back(pat);
+        };
+        for (const char* page : {"/", "/index", "/register", "/login", "/welcome", "/video", "/picture"}) {
+            add(page);
+        }
+        for (int i = 0; (int)linear.patterns.size() < n - 1; i++) {
+            std::string base = "/api/v1/res" + std::to_string(i);
+            add(base + "/:id");
+            add(base + "/:id/items");
+        }
+        add("/static/*file");
+
+        size_t sink = 0;
+        int lookups = std::max(1, iters / (n >= 1000 ? n / 100 : 1)); // 逐条比较在路由多时太慢，减少次数
+        double linearRate = Measure(lookups, [&](int k) {
+            for (int i = 0; i < k; i++) {
+                const char* p = PATHS[i % 5];
+                sink += linear.Find(p, strlen(p));
+            }
+        });
+        double radixRate = Measure(iters, [&](int k) {
+            HttpRouter::Params params;
+            for (int i = 0; i < k; i++) {
+                const char* p = PATHS[i % 5];
+                sink += router.Find(HttpNames::M_GET, p, strlen(p), &params) != nullptr;
+            }
+        });
+        printf("%8zu %14.0f %14.0f %7.1fx\n", linear.patterns.size(), linearRate, radixRate, radixRate / linearRate);
+        if (sink == 0) {
+            printf("\n");
+        }
+    }
+    return g_failed > 0;
+}
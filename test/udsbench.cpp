@@ -0,0 +1,169 @@
+// 回环 TCP 与 Unix 域 socket 的吞吐对比：同样的并发长连接、同样的请求，分别压测 TCP 端口和 Unix 域路径
+// 用法：./udsbench <port> <unix-path> [连接数=32] [秒数=5] [请求路径=/] [流水线深度=1]
+// 流水线深度 > 1 时每个连接一次发出这么多个请求，全部响应收齐后再发下一批（测服务端的 HTTP/1.1 流水线）
+// 服务端需同时监听两者（ServerOptions::unixPath 非空且 unixOnly = false）
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+struct Client {
+    int fd;
+    std::string in;  // 已收到、尚未凑成完整响应的数据
+    size_t sent;     // 当前这批请求已发出的字节数
+    int pending;     // 当前这批还没收到的响应数
+};
+
+static int Connect(bool unixSock, int port, const char* path) {
+    int fd;
+    if (unixSock) {
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            return -1;
+        }
+    } else {
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            return -1;
+        }
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    return fd;
+}
+
+// 缓冲区开头是否已有一个完整响应，有则返回其长度（按 Content-Length 计算），否则返回 0
+static size_t ResponseLen(const std::string& in) {
+    size_t headerEnd = in.find("\r\n\r\n");
+    if (headerEnd == std::string::npos) {
+        return 0;
+    }
+    size_t bodyLen = 0;
+    for (size_t line = 0; line < headerEnd;) {
+        size_t lineEnd = in.find("\r\n", line);
+        if (lineEnd - line > 15 && strncasecmp(in.c_str() + line, "Content-Length:", 15) == 0) {
+            bodyLen = strtoul(in.c_str() + line + 15, nullptr, 10);
+        }
+        line = lineEnd + 2;
+    }
+    size_t total = headerEnd + 4 + bodyLen;
+    return in.size() >= total ? total : 0;
+}
+
+// 压测一个目标，返回完成的请求数与收到的字节数
+static bool Run(bool unixSock, int port, const char* path, int conns, int secs, const std::string& req, int depth,
+                unsigned long long* done, unsigned long long* bytes) {
+    int epfd = epoll_create1(0);
+    std::vector<Client> clients(conns);
+    for (int i = 0; i < conns; i++) {
+        clients[i].fd = Connect(unixSock, port, path);
+        if (clients[i].fd < 0) {
+            fprintf(stderr, "connect %s failed: %s\n", unixSock ? path : "tcp", strerror(errno));
+            return false;
+        }
+        clients[i].sent = 0;
+        clients[i].pending = depth;
+        epoll_event ev;
+        ev.events = EPOLLIN | EPOLLOUT;
+        ev.data.u32 = i;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, clients[i].fd, &ev);
+    }
+    *done = 0;
+    *bytes = 0;
+    char buf[65536];
+    epoll_event events[256];
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(secs);
+    while (std::chrono::steady_clock::now() < end) {
+        int n = epoll_wait(epfd, events, 256, 100);
+        for (int k = 0; k < n; k++) {
+            Client& c = clients[events[k].data.u32];
+            if ((events[k].events & EPOLLOUT) && c.sent < req.size()) {
+                ssize_t w = write(c.fd, req.data() + c.sent, req.size() - c.sent);
+                if (w > 0) {
+                    c.sent += w;
+                }
+            }
+            if (!(events[k].events & EPOLLIN)) {
+                continue;
+            }
+            ssize_t r;
+            while ((r = read(c.fd, buf, sizeof(buf))) > 0) {
+                c.in.append(buf, r);
+                *bytes += r;
+            }
+            if (r == 0) {
+                fprintf(stderr, "server closed connection\n");
+                return false;
+            }
+            size_t len;
+            while ((len = ResponseLen(c.in)) > 0) {
+                c.in.erase(0, len);
+                (*done)++;
+                if (--c.pending > 0) {
+                    continue;
+                }
+                c.pending = depth;
+                c.sent = 0; // 这一批的响应收齐后发下一批
+                ssize_t w = write(c.fd, req.data(), req.size());
+                if (w > 0) {
+                    c.sent = w;
+                }
+            }
+        }
+    }
+    for (auto& c : clients) {
+        close(c.fd);
+    }
+    close(epfd);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <port> <unix-path> [conns=32] [secs=5] [path=/] [depth=1]\n", argv[0]);
+        return 1;
+    }
+    int port = atoi(argv[1]);
+    const char* unixPath = argv[2];
+    int conns = argc > 3 ? atoi(argv[3]) : 32;
+    int secs = argc > 4 ? atoi(argv[4]) : 5;
+    int depth = argc > 6 ? std::max(atoi(argv[6]), 1) : 1;
+    std::string one = std::string("GET ") + (argc > 5 ? argv[5] : "/") +
+                      " HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n\r\n";
+    std::string req;
+    for (int i = 0; i < depth; i++) {
+        req += one;
+    }
+
+    printf("%-6s %12s %12s\n", "target", "req/s", "MB/s");
+    const char* names[2] = {"tcp", "unix"};
+    for (int t = 0; t < 2; t++) {
+        unsigned long long done = 0;
+        unsigned long long bytes = 0;
+        if (!Run(t == 1, port, unixPath, conns, secs, req, depth, &done, &bytes)) {
+            return 1;
+        }
+        printf("%-6s %12.0f %12.1f\n", names[t], (double)done / secs, (double)bytes / secs / (1 << 20));
+    }
+    return 0;
+}